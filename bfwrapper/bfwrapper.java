@@ -1,11 +1,13 @@
 import java.io.BufferedOutputStream;
 import java.io.ByteArrayOutputStream;
 import java.io.Closeable;
-// import java.io.File;
+import java.io.File;
 import java.io.IOException;
 // import java.io.RandomAccessFile;
 import java.nio.ByteBuffer;
 import java.nio.ByteOrder;
+import java.util.ArrayList;
+import java.util.List;
 // import java.util.Hashtable;
 // import java.nio.MappedByteBuffer;
 // import java.nio.channels.FileChannel;
@@ -19,6 +21,7 @@ import loci.formats.ChannelFiller;
 import loci.formats.FormatTools;
 import loci.formats.IFormatReader;
 import loci.formats.ImageReader;
+import loci.formats.Memoizer;
 import loci.formats.meta.IMetadata;
 import loci.formats.meta.MetadataRetrieve;
 import loci.formats.ome.OMEXMLMetadata;
@@ -26,30 +29,67 @@ import loci.formats.services.OMEXMLService;
 import loci.formats.FormatException;
 import ome.units.UNITS;
 import ome.units.quantity.Length;
+import ome.units.quantity.Quantity;
 import ome.units.quantity.Time;
+import ome.xml.model.primitives.Color;
 
 public class bfwrapper implements Closeable {
     private IFormatReader reader;
     private OMEXMLService service;
     private IMetadata meta;
     // private MappedByteBuffer mapped_buffer;
+    // reused by `openBytesInto` / `openPlanes`, grown on demand
+    private byte[] scratch = new byte[0];
+    // `Memoizer` cache directory, null when disabled
+    private File memoDirectory;
 
     public bfwrapper() {
         try {
             DebugTools.setRootLevel("ERROR");
-            // [ChannelFiller](https://github.com/ome/bioformats/blob/develop/components/formats-bsd/src/loci/formats/ChannelFiller.java)
-            // [ChannelMerger](https://github.com/ome/bioformats/blob/develop/components/formats-bsd/src/loci/formats/ChannelMerger.java)
-            // [ChannelSeparator](https://github.com/ome/bioformats/blob/develop/components/formats-bsd/src/loci/formats/ChannelSeparator.java)
-            reader = new ChannelFiller(new ImageReader());
-            reader.setMetadataFiltered(true);
-            reader.setOriginalMetadataPopulated(true);
-            reader.setGroupFiles(false);
             ServiceFactory factory = new ServiceFactory();
             service = factory.getInstance(OMEXMLService.class);
             meta = service.createOMEXMLMetadata();
-            reader.setMetadataStore(meta);
+            reader = createReader(true);
+        } catch (Exception e) {
+            e.printStackTrace();
+        }
+    }
+
+    private IFormatReader createReader(boolean flattened) {
+        // [ChannelFiller](https://github.com/ome/bioformats/blob/develop/components/formats-bsd/src/loci/formats/ChannelFiller.java)
+        // [ChannelMerger](https://github.com/ome/bioformats/blob/develop/components/formats-bsd/src/loci/formats/ChannelMerger.java)
+        // [ChannelSeparator](https://github.com/ome/bioformats/blob/develop/components/formats-bsd/src/loci/formats/ChannelSeparator.java)
+        IFormatReader r = new ChannelFiller(new ImageReader());
+        if (memoDirectory != null) {
+            // [Memoizer](https://github.com/ome/bioformats/blob/develop/components/formats-bsd/src/loci/formats/Memoizer.java)
+            // memo files do not record the reader options, flattened and unflattened states are kept apart
+            File dir = flattened ? memoDirectory : new File(memoDirectory, "unflattened");
+            r = new Memoizer(r, Memoizer.DEFAULT_MINIMUM_ELAPSED, dir);
+        }
+        r.setFlattenedResolutions(flattened);
+        r.setMetadataFiltered(true);
+        r.setOriginalMetadataPopulated(true);
+        r.setGroupFiles(false);
+        r.setMetadataStore(meta);
+        return r;
+    }
+
+    // files whose `setId` takes longer than `Memoizer.DEFAULT_MINIMUM_ELAPSED` get their initialized reader
+    // serialized under `directory`, later `setId` calls on the unchanged file deserialize it instead of parsing
+    // the file again. Null or empty disables it. Closes the current file.
+    public boolean setMemoDirectory(String directory) {
+        try {
+            File dir = directory == null || directory.isEmpty() ? null : new File(directory);
+            if (dir != null && !dir.isDirectory() && !dir.mkdirs())
+                return false;
+            boolean flattened = reader.hasFlattenedResolutions();
+            reader.close();
+            memoDirectory = dir;
+            reader = createReader(flattened);
+            return true;
         } catch (Exception e) {
             e.printStackTrace();
+            return false;
         }
     }
 
@@ -82,14 +122,32 @@ public class bfwrapper implements Closeable {
 
     // https://bio-formats.readthedocs.io/en/v8.0.0/developers/wsi.html
     public void setFlattenedResolutions(boolean flag) {
-        reader.setFlattenedResolutions(flag);
+        if (memoDirectory == null || flag == reader.hasFlattenedResolutions()) {
+            reader.setFlattenedResolutions(flag);
+            return;
+        }
+        // the memo directory depends on the flag
+        try {
+            reader.close();
+        } catch (IOException e) {
+            e.printStackTrace();
+        }
+        reader = createReader(flag);
     }
 
     public boolean setId(String filePath) {
         if (!reader.isThisType(filePath))
             return false;
         try {
+            // a fresh store per file, the OME-XML would otherwise keep the images of the previous file
+            if (reader.getCurrentFile() != null)
+                reader.close();
+            meta = service.createOMEXMLMetadata();
+            reader.setMetadataStore(meta);
             reader.setId(filePath);
+            // a reader loaded from its memo file may come with its own store
+            if (reader.getMetadataStore() instanceof IMetadata)
+                meta = (IMetadata) reader.getMetadataStore();
             return true;
         } catch (Exception e) {
             e.printStackTrace();
@@ -97,6 +155,60 @@ public class bfwrapper implements Closeable {
         }
     }
 
+    // key / value pairs of the OME image `series` and of its instrument, read from the metadata store
+    // instead of dumping and parsing the whole OME-XML, unset fields are skipped
+    // https://ome-model.readthedocs.io/en/stable/developers/model-overview.html
+    public String[] getSeriesMetadata(int series) {
+        List<String> kv = new ArrayList<>();
+        try {
+            add(kv, "Name", meta.getImageName(series));
+            add(kv, "Description", meta.getImageDescription(series));
+            add(kv, "AcquisitionDate", meta.getImageAcquisitionDate(series));
+            for (int c = 0; c < meta.getChannelCount(series); c++) {
+                String channel = "Channel:" + c + ":";
+                add(kv, channel + "Name", meta.getChannelName(series, c));
+                add(kv, channel + "ExcitationWavelength", meta.getChannelExcitationWavelength(series, c));
+                add(kv, channel + "EmissionWavelength", meta.getChannelEmissionWavelength(series, c));
+            }
+
+            String instrumentRef = meta.getImageInstrumentRef(series);
+            for (int i = 0; instrumentRef != null && i < meta.getInstrumentCount(); i++) {
+                if (!instrumentRef.equals(meta.getInstrumentID(i)))
+                    continue;
+                add(kv, "Instrument", instrumentRef);
+                add(kv, "Microscope:Manufacturer", meta.getMicroscopeManufacturer(i));
+                add(kv, "Microscope:Model", meta.getMicroscopeModel(i));
+                for (int o = 0; o < meta.getObjectiveCount(i); o++) {
+                    String objective = "Objective:" + o + ":";
+                    add(kv, objective + "Model", meta.getObjectiveModel(i, o));
+                    add(kv, objective + "NominalMagnification", meta.getObjectiveNominalMagnification(i, o));
+                    add(kv, objective + "LensNA", meta.getObjectiveLensNA(i, o));
+                    add(kv, objective + "Immersion", meta.getObjectiveImmersion(i, o));
+                }
+                for (int d = 0; d < meta.getDetectorCount(i); d++) {
+                    String detector = "Detector:" + d + ":";
+                    add(kv, detector + "Model", meta.getDetectorModel(i, d));
+                    add(kv, detector + "Type", meta.getDetectorType(i, d));
+                }
+                break;
+            }
+        } catch (Exception e) {
+            // `series` out of range, or a store without these elements
+        }
+        return kv.toArray(new String[0]);
+    }
+
+    private static void add(List<String> kv, String key, Object value) {
+        if (value == null)
+            return;
+        kv.add(key);
+        if (value instanceof Quantity) {
+            Quantity q = (Quantity) value;
+            kv.add(q.value() + " " + q.unit().getSymbol());
+        } else
+            kv.add(value.toString());
+    }
+
     // https://bio-formats.readthedocs.io/en/v8.0.0/developers/file-reader.html
     // https://github.com/ome/bioformats/blob/develop/components/bio-formats-tools/src/loci/formats/tools/ImageInfo.java#L522
     public String getMetadata() {
@@ -257,6 +369,14 @@ public class bfwrapper implements Closeable {
         return reader.isLittleEndian();
     }
 
+    /**
+     * Returns true if channels of RGB planes returned by openBytes are
+     * interleaved (RGBRGB...) rather than planar (RRR...GGG...BBB...).
+     */
+    public boolean isInterleaved() {
+        return reader.isInterleaved();
+    }
+
     /**
      * Gets a five-character string representing the
      * dimension order in which planes will be returned. Valid orders are:
@@ -308,6 +428,47 @@ public class bfwrapper implements Closeable {
         return new int[] { color.getRed(), color.getGreen(), color.getBlue(), color.getAlpha() };
     }
 
+    // number of `getSeriesInfo` fields before the channel colors, the layout is mirrored by `SeriesInfo` in reader.cpp
+    private static final int SERIES_INFO_FIELDS = 16;
+
+    // the fields `Reader` caches for the current series / resolution in one call instead of one per field:
+    // image count, size x/y/z/effective c/t, physical size x/y/z (mm) / t (s), pixel type, rgb channel count,
+    // little endian, interleaved, plane size, bits per pixel, then r/g/b/a per channel (-1 if no color is set)
+    public double[] getSeriesInfo() {
+        int sizeC = reader.getEffectiveSizeC();
+        double[] info = new double[SERIES_INFO_FIELDS + 4 * sizeC];
+        info[0] = reader.getImageCount();
+        info[1] = reader.getSizeX();
+        info[2] = reader.getSizeY();
+        info[3] = reader.getSizeZ();
+        info[4] = sizeC;
+        info[5] = reader.getSizeT();
+        info[6] = getPhysSizeX();
+        info[7] = getPhysSizeY();
+        info[8] = getPhysSizeZ();
+        info[9] = getPhysSizeT();
+        info[10] = reader.getPixelType();
+        info[11] = reader.getRGBChannelCount();
+        info[12] = reader.isLittleEndian() ? 1 : 0;
+        info[13] = reader.isInterleaved() ? 1 : 0;
+        info[14] = FormatTools.getPlaneSize(reader);
+        info[15] = reader.getBitsPerPixel();
+        for (int c = 0; c < sizeC; c++) {
+            int offset = SERIES_INFO_FIELDS + 4 * c;
+            Color color = null;
+            try {
+                color = meta.getChannelColor(getSeries(), c);
+            } catch (Exception e) {
+                // no channel metadata for this series
+            }
+            info[offset] = color == null ? -1 : color.getRed();
+            info[offset + 1] = color == null ? -1 : color.getGreen();
+            info[offset + 2] = color == null ? -1 : color.getBlue();
+            info[offset + 3] = color == null ? -1 : color.getAlpha();
+        }
+        return info;
+    }
+
     // https://github.com/ome/bioformats/blob/develop/components/formats-api/src/loci/formats/IFormatReader.java#L245
     /**
      * Obtains the specified image plane from the current file as a byte array.
@@ -452,6 +613,61 @@ public class bfwrapper implements Closeable {
         buffer.put(openPlane(no));
     }
 
+    /**
+     * Same as {@link #openBytes(int, int, int, int, int)} but writes into a
+     * caller-provided (direct) buffer.
+     *
+     * @return false if the buffer is too small or the read failed.
+     */
+    public boolean openBytesInto(int no, int x, int y, int w, int h, ByteBuffer buffer) {
+        try {
+            final int size = w * h * reader.getRGBChannelCount()
+                    * FormatTools.getBytesPerPixel(reader.getPixelType());
+            if (buffer.capacity() < size)
+                return false;
+            buffer.clear();
+            reader.openBytes(no, scratch(size), x, y, w, h);
+            buffer.put(scratch, 0, size);
+            return true;
+        } catch (Exception e) {
+            e.printStackTrace();
+            return false;
+        }
+    }
+
+    private byte[] scratch(int size) {
+        // readers only require `buf.length >= size`, so grow only and keep it for smaller (edge) tiles
+        if (scratch.length < size)
+            scratch = new byte[size];
+        return scratch;
+    }
+
+    /**
+     * Reads the raw ({@link #openBytes(int)} layout) planes <code>nos</code>
+     * back to back into a caller-provided (direct) buffer of at least
+     * <code>nos.length * getPlaneSize()</code> bytes, so a whole stack costs
+     * a single JNI call.
+     *
+     * @return false if the buffer is too small or a read failed.
+     */
+    public boolean openPlanes(int[] nos, ByteBuffer buffer) {
+        try {
+            final int size = getPlaneSize();
+            if ((long) size * nos.length > buffer.capacity())
+                return false;
+            buffer.clear();
+            final byte[] buf = scratch(size);
+            for (int no : nos) {
+                reader.openBytes(no, buf);
+                buffer.put(buf, 0, size);
+            }
+            return true;
+        } catch (Exception e) {
+            e.printStackTrace();
+            return false;
+        }
+    }
+
     public boolean openPlanes(int start, int length, ByteBuffer buffer) {
         try {
             buffer.clear();
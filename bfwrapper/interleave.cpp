@@ -0,0 +1,167 @@
+#include "interleave.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#define INTERLEAVE_SSSE3
+#include <tmmintrin.h>
+#endif
+
+namespace
+{
+    // `pshufb` mask reversing every `BPP` byte group of a 16 bytes register
+    template <int BPP>
+    constexpr auto swapMask()
+    {
+        std::array<std::int8_t, 16> mask{};
+        for (int i = 0; i < 16; i++)
+            mask[i] = static_cast<std::int8_t>(i / BPP * BPP + (BPP - 1 - i % BPP));
+        return mask;
+    }
+
+    // `pshufb` masks building output register `k` from channel register `c`:
+    // one block is `16 / BPP` pixels, read as `C` planar registers and written as `C` interleaved ones,
+    // lanes of other channels are zeroed (-1) so the `C` shuffles of one output register can be or-ed
+    template <int C, int BPP, bool SWAP>
+    constexpr auto interleaveMasks()
+    {
+        std::array<std::array<std::array<std::int8_t, 16>, C>, C> masks{};
+        for (int k = 0; k < C; k++)
+            for (int j = 0; j < 16; j++)
+            {
+                int g = k * 16 + j;
+                int p = g / (C * BPP), c = g / BPP % C, b = g % BPP;
+                for (int cc = 0; cc < C; cc++)
+                    masks[k][cc][j] = cc == c ? static_cast<std::int8_t>(p * BPP + (SWAP ? BPP - 1 - b : b)) : -1;
+            }
+        return masks;
+    }
+
+    template <int BPP>
+    void byteSwapImpl(std::byte* data, std::size_t count)
+    {
+        std::size_t i = 0;
+#ifdef INTERLEAVE_SSSE3
+        static constexpr auto mask = swapMask<BPP>();
+        auto const m = _mm_loadu_si128(reinterpret_cast<__m128i const*>(mask.data()));
+        constexpr std::size_t step = 16 / BPP;
+        for (; i + step <= count; i += step)
+        {
+            auto* p = reinterpret_cast<__m128i*>(data + i * BPP);
+            _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), m));
+        }
+#endif
+        for (; i < count; i++)
+            std::reverse(data + i * BPP, data + (i + 1) * BPP);
+    }
+
+    template <int C, int BPP, bool SWAP>
+    void interleaveImpl(std::byte const* src, std::byte* dst, std::size_t pixels)
+    {
+        std::size_t p = 0;
+#ifdef INTERLEAVE_SSSE3
+        static constexpr auto masks = interleaveMasks<C, BPP, SWAP>();
+        constexpr std::size_t step = 16 / BPP;
+        for (; p + step <= pixels; p += step)
+        {
+            __m128i in[C];
+            for (int c = 0; c < C; c++)
+                in[c] = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + (c * pixels + p) * BPP));
+            for (int k = 0; k < C; k++)
+            {
+                auto out = _mm_setzero_si128();
+                for (int c = 0; c < C; c++)
+                {
+                    auto m = _mm_loadu_si128(reinterpret_cast<__m128i const*>(masks[k][c].data()));
+                    out = _mm_or_si128(out, _mm_shuffle_epi8(in[c], m));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + p * C * BPP + k * 16), out);
+            }
+        }
+#endif
+        for (; p < pixels; p++)
+            for (int c = 0; c < C; c++)
+                for (int b = 0; b < BPP; b++)
+                    dst[(p * C + c) * BPP + b] = src[(c * pixels + p) * BPP + (SWAP ? BPP - 1 - b : b)];
+    }
+
+    template <int C, int BPP>
+    void interleaveSwap(std::byte const* src, std::byte* dst, std::size_t pixels, bool swap)
+    {
+        if (swap)
+            interleaveImpl<C, BPP, true>(src, dst, pixels);
+        else
+            interleaveImpl<C, BPP, false>(src, dst, pixels);
+    }
+
+    template <int C>
+    bool interleaveFixed(std::byte const* src, std::byte* dst, std::size_t pixels, int bpp, bool swap)
+    {
+        switch (bpp)
+        {
+        case 1:
+            interleaveImpl<C, 1, false>(src, dst, pixels);
+            return true;
+        case 2:
+            interleaveSwap<C, 2>(src, dst, pixels, swap);
+            return true;
+        case 4:
+            interleaveSwap<C, 4>(src, dst, pixels, swap);
+            return true;
+        case 8:
+            interleaveSwap<C, 8>(src, dst, pixels, swap);
+            return true;
+        }
+        return false;
+    }
+
+    void interleaveGeneric(std::byte const* src, std::byte* dst, std::size_t pixels, int channels, int bpp, bool swap)
+    {
+        for (std::size_t p = 0; p < pixels; p++)
+            for (int c = 0; c < channels; c++)
+                for (int b = 0; b < bpp; b++)
+                    dst[(p * channels + c) * bpp + b] = src[(c * pixels + p) * bpp + (swap ? bpp - 1 - b : b)];
+    }
+} // namespace
+
+void byteSwap(std::byte* data, std::size_t count, int bpp)
+{
+    switch (bpp)
+    {
+    case 1:
+        return;
+    case 2:
+        return byteSwapImpl<2>(data, count);
+    case 4:
+        return byteSwapImpl<4>(data, count);
+    case 8:
+        return byteSwapImpl<8>(data, count);
+    }
+    for (std::size_t i = 0; i < count; i++)
+        std::reverse(data + i * bpp, data + (i + 1) * bpp);
+}
+
+void planarToInterleaved(std::byte const* src, std::byte* dst, std::size_t pixels, int channels, int bpp, bool swap)
+{
+    bool done = false;
+    switch (channels)
+    {
+    case 1:
+        std::memcpy(dst, src, pixels * bpp);
+        if (swap) byteSwap(dst, pixels, bpp);
+        return;
+    case 2:
+        done = interleaveFixed<2>(src, dst, pixels, bpp, swap);
+        break;
+    case 3:
+        done = interleaveFixed<3>(src, dst, pixels, bpp, swap);
+        break;
+    case 4:
+        done = interleaveFixed<4>(src, dst, pixels, bpp, swap);
+        break;
+    }
+    if (!done) interleaveGeneric(src, dst, pixels, channels, bpp, swap);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+// native replacement for the per-sample loop in `bfwrapper.openPlane`:
+// bring raw `openBytes` output into interleaved little endian layout
+
+// reverses the byte order of `count` samples of `bpp` bytes each, in place
+void byteSwap(std::byte* data, std::size_t count, int bpp);
+
+// `src` holds `channels` planes of `pixels` samples (CCC...), `dst` receives them interleaved (RGBRGB...)
+// with every sample byte swapped if `swap` is set, `src` and `dst` must not overlap
+void planarToInterleaved(std::byte const* src, std::byte* dst, std::size_t pixels, int channels, int bpp, bool swap);
@@ -1,9 +1,16 @@
 #include "jvmwrapper.hpp"
 
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <cassert>
+#include <mutex>
+#include <optional>
 
 #ifdef _WIN32
 #else
@@ -15,7 +22,6 @@
 JVMWrapper* JVMWrapper::m_jvm_wrapper_instance_ptr = nullptr;
 JVMWrapper::JNI_CreateJavaVMFuncPtr JVMWrapper::m_jni_create_jvm_func_ptr = nullptr;
 JavaVM* JVMWrapper::m_jvm_ptr = nullptr;
-JNIEnv* JVMWrapper::m_jni_env_ptr = nullptr;
 JavaVMInitArgs JVMWrapper::m_jvm_init_args{};
 
 #ifdef _WIN32
@@ -69,12 +75,150 @@ jmethodID JVMWrapper::longInitMethod = nullptr;
 jmethodID JVMWrapper::numberDoubleValueMethod = nullptr;
 jmethodID JVMWrapper::throwableGetMessageMethod = nullptr;
 
+namespace
+{
+    std::mutex jvm_mutex;
+    std::optional<JVMOptions> jvm_options; // guarded by `jvm_mutex`
+
+    std::string trim(std::string const& str)
+    {
+        auto begin = str.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos) return {};
+        return str.substr(begin, str.find_last_not_of(" \t\r\n") - begin + 1);
+    }
+
+    // splits on whitespace, for `BIOIMREAD_JVM_OPTIONS`
+    std::vector<std::string> split(std::string const& str)
+    {
+        std::vector<std::string> res;
+        std::istringstream ss(str);
+        for (std::string s; ss >> s;)
+            res.push_back(s);
+        return res;
+    }
+
+    // bumped by `createJVM` and `destroyJVM`, the envs of threads attached to an older VM are stale
+    std::atomic<std::uint64_t> jvm_generation = 0;
+
+    // a `JNIEnv` is only valid on its own thread
+    struct ThreadEnv
+    {
+        JavaVM* jvm = nullptr; // set only if this thread was attached by us
+        JNIEnv* env = nullptr;
+        std::uint64_t generation = 0; // `jvm_generation` `env` belongs to
+
+        ~ThreadEnv()
+        {
+            if (!jvm) return;
+            // the VM may have been destroyed (and its library unloaded) since this thread was attached,
+            // `destroyJVM` bumps the generation under the lock before tearing it down
+            std::lock_guard lock(jvm_mutex);
+            if (generation == jvm_generation) jvm->DetachCurrentThread();
+        }
+    };
+    thread_local ThreadEnv thread_env;
+} // namespace
+
+std::string getExecutableDir();
+
+JVMOptions JVMOptions::fromEnvironment()
+{
+    JVMOptions options;
+    if (auto const* path = std::getenv("BIOIMREAD_JVM_CONFIG"))
+        options.loadFile(path);
+    else if (auto path = std::filesystem::path(getExecutableDir()) / "jvm.cfg"; std::filesystem::exists(path))
+        options.loadFile(path.string());
+
+    auto env = [](const char* name, std::string& field) {
+        if (auto const* value = std::getenv(name)) field = value;
+    };
+    env("BIOIMREAD_JVM_MAX_HEAP", options.max_heap);
+    env("BIOIMREAD_JVM_INITIAL_HEAP", options.initial_heap);
+    env("BIOIMREAD_JVM_GC", options.gc);
+    env("BIOIMREAD_JVM_TLAB_SIZE", options.tlab_size);
+    env("BIOIMREAD_JVM_CDS_ARCHIVE", options.cds_archive);
+    if (auto const* extra = std::getenv("BIOIMREAD_JVM_OPTIONS"))
+        for (auto& option : split(extra))
+            options.extra.push_back(std::move(option));
+    return options;
+}
+
+bool JVMOptions::loadFile(std::string const& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "failed to open JVM options file: " << path << std::endl;
+        return false;
+    }
+    for (std::string line; std::getline(file, line);)
+    {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        auto eq = line.find('=');
+        if (eq == std::string::npos)
+        {
+            std::cerr << "ignored JVM option line without '=': " << line << std::endl;
+            continue;
+        }
+        auto key = trim(line.substr(0, eq));
+        auto value = trim(line.substr(eq + 1));
+        if (key == "max_heap")
+            max_heap = value;
+        else if (key == "initial_heap")
+            initial_heap = value;
+        else if (key == "gc")
+            gc = value;
+        else if (key == "tlab_size")
+            tlab_size = value;
+        else if (key == "cds_archive")
+            cds_archive = value;
+        else if (key == "option")
+            extra.push_back(value);
+        else
+            std::cerr << "ignored unknown JVM option: " << key << std::endl;
+    }
+    return true;
+}
+
+std::vector<std::string> JVMOptions::toArgs() const
+{
+    std::vector<std::string> args;
+    if (!max_heap.empty()) args.push_back("-Xmx" + max_heap);
+    if (!initial_heap.empty()) args.push_back("-Xms" + initial_heap);
+    if (!gc.empty()) args.push_back("-XX:+Use" + gc + "GC");
+    if (!tlab_size.empty()) args.push_back("-XX:TLABSize=" + tlab_size);
+    if (!cds_archive.empty())
+    {
+        // `auto` silently falls back to no sharing if the archive does not match this JVM / classpath
+        args.push_back("-XX:SharedArchiveFile=" + cds_archive);
+        args.push_back("-Xshare:auto");
+    }
+    args.insert(args.end(), extra.begin(), extra.end());
+    return args;
+}
+
 JVMWrapper* JVMWrapper::getInstance(std::vector<std::string> args)
 {
+    std::lock_guard lock(jvm_mutex);
     if (m_jvm_wrapper_instance_ptr == nullptr && createJVM(args)) m_jvm_wrapper_instance_ptr = new JVMWrapper();
     return m_jvm_wrapper_instance_ptr;
 }
 
+void JVMWrapper::setOptions(JVMOptions options)
+{
+    std::lock_guard lock(jvm_mutex);
+    if (m_jvm_ptr) std::cerr << "JVM options are ignored, the JVM is already created" << std::endl;
+    jvm_options = std::move(options);
+}
+
+JVMOptions JVMWrapper::getOptions()
+{
+    std::lock_guard lock(jvm_mutex);
+    if (!jvm_options) jvm_options = JVMOptions::fromEnvironment();
+    return *jvm_options;
+}
+
 std::string getExecutableDir()
 {
     char buffer[1024];
@@ -153,8 +297,22 @@ bool JVMWrapper::createJVM(std::vector<std::string> args)
         if (entry.path().extension() == ".jar") java_class_path += "/" + entry.path().string() + ";";
 
     // JNI initialization
+    if (!jvm_options) jvm_options = JVMOptions::fromEnvironment();
+    if (jvm_options->cds_archive == "none")
+        jvm_options->cds_archive.clear();
+    else if (jvm_options->cds_archive.empty())
+    {
+        // not while a new archive is being dumped, the JVM refuses to both map and dump a dynamic archive
+        auto dumping = std::ranges::any_of(jvm_options->extra, [](std::string const& option) {
+            return option.starts_with("-XX:ArchiveClassesAtExit");
+        });
+        auto archive = std::filesystem::path(java_dir_path) / JVMOptions::default_cds_archive;
+        if (!dumping && std::filesystem::exists(archive)) jvm_options->cds_archive = archive.string();
+    }
+    auto jvm_args = jvm_options->toArgs();
     std::vector<JavaVMOption> options;
-    options.push_back(JavaVMOption{.optionString = const_cast<char*>("-Xmx256m")});
+    for (auto const& arg : jvm_args)
+        options.push_back(JavaVMOption{.optionString = const_cast<char*>(arg.c_str())});
     options.push_back(JavaVMOption{.optionString = const_cast<char*>(java_class_path.c_str())});
 #ifdef DEBUG_GC
     // https://www.ibm.com/docs/en/sdk-java-technology/8?topic=data-xtgc-tracing
@@ -167,47 +325,130 @@ bool JVMWrapper::createJVM(std::vector<std::string> args)
     vm_args.options = options.data();
     vm_args.ignoreUnrecognized = false;
 
-    jint rc = m_jni_create_jvm_func_ptr(&m_jvm_ptr, (void**)&m_jni_env_ptr, &vm_args);
+    jint rc = m_jni_create_jvm_func_ptr(&m_jvm_ptr, (void**)&thread_env.env, &vm_args);
     if (rc != JNI_OK)
     {
-        std::cerr << "Error creating JVM: " << rc << std::endl;
+        std::cerr << "Error creating JVM: " << rc << ", options:";
+        for (auto const& arg : jvm_args)
+            std::cerr << " " << arg;
+        std::cerr << std::endl;
         return false;
     }
 
-    jint ver = m_jni_env_ptr->GetVersion();
+    thread_env.generation = ++jvm_generation;
+    jint ver = thread_env.env->GetVersion();
     std::cout << "JVM created successfully: Version" << ((ver >> 16) & 0x0f) << "." << (ver & 0x0f) << std::endl;
     return true;
 }
 
 void JVMWrapper::destroyJVM()
 {
-    if (m_jvm_ptr) m_jvm_ptr->DestroyJavaVM();
+    JavaVM* jvm = nullptr;
+    auto jvm_dll = decltype(m_jvm_dll){};
+    {
+        std::lock_guard lock(jvm_mutex);
+        // the other attached threads leave the VM alone from now on (see `ThreadEnv`), `DestroyJavaVM`
+        // detaches the calling one
+        ++jvm_generation;
+        thread_env = {};
+        std::swap(jvm, m_jvm_ptr);
+        std::swap(jvm_dll, m_jvm_dll);
+        m_jni_create_jvm_func_ptr = nullptr;
+        // the wrapper has no state, pointers handed out stay usable for the static calls
+        m_jvm_wrapper_instance_ptr = nullptr;
+    }
+    // unlocked: the attached threads are daemons so `DestroyJavaVM` does not wait for them, but it runs Java code
+    // (shutdown hooks, finalization) that may call back into threads needing `jvm_mutex`
+    if (jvm) jvm->DestroyJavaVM();
 #ifdef _WIN32
-    if (m_jvm_dll) FreeLibrary(m_jvm_dll);
+    if (jvm_dll) FreeLibrary(jvm_dll);
 #else
-    if (m_jvm_dll) dlclose(m_jvm_dll);
+    if (jvm_dll) dlclose(jvm_dll);
 #endif
 }
 
 void JVMWrapper::checkException()
 {
-    if (m_jni_env_ptr->ExceptionCheck())
+    auto* env = getJNIEnv();
+    if (env->ExceptionCheck())
     {
-        m_jni_env_ptr->ExceptionDescribe();
-        m_jni_env_ptr->ExceptionClear();
+        env->ExceptionDescribe();
+        env->ExceptionClear();
     }
 }
 
 JNIEnv* JVMWrapper::getJNIEnv()
 {
-    return m_jni_env_ptr;
+    auto generation = jvm_generation.load();
+    if (thread_env.env && thread_env.generation == generation) return thread_env.env;
+    // attached to a destroyed VM, there is nothing left to detach from
+    thread_env = {};
+    auto* jvm = m_jvm_ptr;
+    if (jvm == nullptr) return nullptr;
+
+    JNIEnv* env = nullptr;
+    auto rc = jvm->GetEnv((void**)&env, JNI_VERSION_1_8);
+    if (rc == JNI_EDETACHED)
+    {
+        // as a daemon, `destroyJVM` does not wait for the workers (reader pools, servers) still attached
+        if (jvm->AttachCurrentThreadAsDaemon((void**)&env, nullptr) != JNI_OK)
+        {
+            std::cerr << "Error: failed to attach thread to JVM" << std::endl;
+            return nullptr;
+        }
+        thread_env.jvm = jvm;
+    }
+    else if (rc != JNI_OK)
+    {
+        std::cerr << "Error: failed to get JNIEnv: " << rc << std::endl;
+        return nullptr;
+    }
+    thread_env.env = env;
+    thread_env.generation = generation;
+    return env;
+}
+
+JVMWrapper::GCStats JVMWrapper::getGCStats()
+{
+    auto* env = getJNIEnv();
+    assert(env);
+
+    GCStats stats;
+    jclass factory_cls = env->FindClass("java/lang/management/ManagementFactory");
+    jclass list_cls = env->FindClass("java/util/List");
+    jclass bean_cls = env->FindClass("java/lang/management/GarbageCollectorMXBean");
+    if (factory_cls && list_cls && bean_cls)
+    {
+        jobject beans = env->CallStaticObjectMethod(
+            factory_cls, getMethodID(factory_cls, "getGarbageCollectorMXBeans", "()Ljava/util/List;", true));
+        jmethodID size = getMethodID(list_cls, "size", "()I");
+        jmethodID get = getMethodID(list_cls, "get", "(I)Ljava/lang/Object;");
+        jmethodID count = getMethodID(bean_cls, "getCollectionCount", "()J");
+        jmethodID time = getMethodID(bean_cls, "getCollectionTime", "()J");
+        for (jint i = 0, n = beans ? env->CallIntMethod(beans, size) : 0; i < n; i++)
+        {
+            jobject bean = env->CallObjectMethod(beans, get, i);
+            // -1 if the collector does not report it
+            stats.collections += std::max<jlong>(0, env->CallLongMethod(bean, count));
+            stats.pause_ms += std::max<jlong>(0, env->CallLongMethod(bean, time));
+            env->DeleteLocalRef(bean);
+        }
+        env->DeleteLocalRef(beans);
+    }
+    else
+        checkException();
+    env->DeleteLocalRef(bean_cls);
+    env->DeleteLocalRef(list_cls);
+    env->DeleteLocalRef(factory_cls);
+    return stats;
 }
 
 jclass JVMWrapper::findClass(const char* className)
 {
-    assert(m_jni_env_ptr);
+    auto* env = getJNIEnv();
+    assert(env);
 
-    jclass javaClass = m_jni_env_ptr->FindClass(className);
+    jclass javaClass = env->FindClass(className);
     if (!javaClass)
     {
         std::cerr << "Couldn't find Java class: " << className << std::endl;
@@ -216,18 +457,19 @@ jclass JVMWrapper::findClass(const char* className)
     }
     else
     {
-        jclass globalClass = (jclass)m_jni_env_ptr->NewGlobalRef(javaClass);
-        m_jni_env_ptr->DeleteLocalRef(javaClass);
+        jclass globalClass = (jclass)env->NewGlobalRef(javaClass);
+        env->DeleteLocalRef(javaClass);
         return globalClass;
     }
 }
 
 jmethodID JVMWrapper::getMethodID(jclass javaClass, const char* methodName, const char* signature, bool isStatic)
 {
-    assert(m_jni_env_ptr);
+    auto* env = getJNIEnv();
+    assert(env);
 
-    jmethodID javaMethodID = isStatic ? m_jni_env_ptr->GetStaticMethodID(javaClass, methodName, signature) :
-                                        javaMethodID = m_jni_env_ptr->GetMethodID(javaClass, methodName, signature);
+    jmethodID javaMethodID = isStatic ? env->GetStaticMethodID(javaClass, methodName, signature) :
+                                        env->GetMethodID(javaClass, methodName, signature);
     if (!javaMethodID)
     {
         std::cerr << "Couldn't find Java method ID: " << methodName << " " << signature << std::endl;
@@ -238,9 +480,10 @@ jmethodID JVMWrapper::getMethodID(jclass javaClass, const char* methodName, cons
 
 jfieldID JVMWrapper::getFieldID(jclass javaClass, const char* fieldName, const char* signature)
 {
-    assert(m_jni_env_ptr);
+    auto* env = getJNIEnv();
+    assert(env);
 
-    jfieldID javaFieldID = m_jni_env_ptr->GetFieldID(javaClass, fieldName, signature);
+    jfieldID javaFieldID = env->GetFieldID(javaClass, fieldName, signature);
     if (!javaFieldID)
     {
         std::cerr << "Couldn't find Java field ID: " << fieldName << " " << signature << std::endl;
@@ -251,41 +494,44 @@ jfieldID JVMWrapper::getFieldID(jclass javaClass, const char* fieldName, const c
 
 jstring JVMWrapper::getClassName(jclass javaClass)
 {
-    assert(m_jni_env_ptr);
+    auto* env = getJNIEnv();
+    assert(env);
 
     if (!classClass) classClass = findClass("java/lang/Class");
-    return (jstring)m_jni_env_ptr->CallObjectMethod(javaClass,
-                                                    getMethodID(classClass, "getName", "()Ljava/lang/String;", false));
+    return (jstring)env->CallObjectMethod(javaClass, getMethodID(classClass, "getName", "()Ljava/lang/String;", false));
 }
 
 jobjectArray JVMWrapper::newObjectArray(int length, jobject initial)
 {
-    assert(m_jni_env_ptr);
+    auto* env = getJNIEnv();
+    assert(env);
 
     if (!objectClass) objectClass = findClass("java/lang/Object");
-    return m_jni_env_ptr->NewObjectArray(length, objectClass, initial);
+    return env->NewObjectArray(length, objectClass, initial);
 }
 
 void JVMWrapper::throwException(jclass clazz, const char* message)
 {
-    assert(m_jni_env_ptr);
+    auto* env = getJNIEnv();
+    assert(env);
 
-    m_jni_env_ptr->ExceptionClear();
-    m_jni_env_ptr->ThrowNew(clazz, message);
+    env->ExceptionClear();
+    env->ThrowNew(clazz, message);
 }
 
 void JVMWrapper::throwException(const char* className, const char* message)
 {
-    assert(m_jni_env_ptr);
+    auto* env = getJNIEnv();
+    assert(env);
 
     jclass clazz = findClass(className);
     throwException(clazz, message);
-    m_jni_env_ptr->DeleteLocalRef(clazz);
+    env->DeleteLocalRef(clazz);
 }
 
 void JVMWrapper::initCache()
 {
-    assert(m_jni_env_ptr);
+    assert(getJNIEnv());
 
     classClass = findClass("java/lang/Class");
     objectClass = findClass("java/lang/Object");
@@ -10,12 +10,50 @@
 #include <windows.h>
 #endif // _WIN32
 
+// options of the JVM created by the first `JVMWrapper::getInstance`, empty fields keep the JVM defaults
+struct JVMOptions
+{
+    std::string max_heap = "256m";  // -Xmx
+    std::string initial_heap;       // -Xms
+    std::string gc;                 // G1, Parallel, Serial, Z or Shenandoah
+    std::string tlab_size;          // -XX:TLABSize, initial thread local allocation buffer size
+    std::string cds_archive;        // -XX:SharedArchiveFile, AppCDS archive, see `default_cds_archive`
+    std::vector<std::string> extra; // passed as is, e.g. `-XX:TieredStopAtLevel=1`
+
+    // defaults, overridden by the config file (`$BIOIMREAD_JVM_CONFIG` or `jvm.cfg` next to the executable)
+    // and then by `BIOIMREAD_JVM_MAX_HEAP/INITIAL_HEAP/GC/TLAB_SIZE/CDS_ARCHIVE/OPTIONS` environment variables
+    static JVMOptions fromEnvironment();
+    // `key = value` lines with keys named like the fields, `option` may repeat, `#` starts a comment
+    bool loadFile(std::string const& path);
+    std::vector<std::string> toArgs() const;
+
+    // dumped next to the jars by the `*_cds` build targets and used when `cds_archive` is empty,
+    // `cds_archive = none` disables it
+    static constexpr char default_cds_archive[] = "bioimread.jsa";
+};
+
 class JVMWrapper
 {
 public:
     static JVMWrapper* getInstance(std::vector<std::string> args = {});
+    // for process shutdown: threads still attached are left alone (they never detach from the destroyed VM),
+    // readers must not be used afterwards
     static void destroyJVM();
 
+    // must be called before the first `getInstance`, otherwise `JVMOptions::fromEnvironment()` is used
+    static void setOptions(JVMOptions options);
+    // options the JVM was (or will be) created with
+    static JVMOptions getOptions();
+
+    struct GCStats
+    {
+        long long collections = 0;
+        long long pause_ms = 0; // accumulated collection time of all collectors
+    };
+    static GCStats getGCStats();
+
+    // env of the calling thread, threads other than the JVM creator are attached (as daemons) on first use
+    // and detached when they exit
     static JNIEnv* getJNIEnv();
     //\note: global reference
     static jclass findClass(const char* className);
@@ -44,7 +82,6 @@ private:
 
 private:
     static JavaVM* m_jvm_ptr;
-    static JNIEnv* m_jni_env_ptr;
 
 private:
     static JVMWrapper* m_jvm_wrapper_instance_ptr;
@@ -1,11 +1,13 @@
 #include <jni.h>
 #include <iostream>
 #include <cassert>
+#include <filesystem>
 
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
 
 #include "jvmwrapper.hpp"
+#include "interleave.hpp"
 #include "stopwatch.hpp"
 
 //#define SHOW_PLANES
@@ -13,6 +15,12 @@
 #define BENCH_RGN
 //#define BENCH_CRI
 //#define BENCH_DBB
+//#define BENCH_MID
+//#define BENCH_KERNEL
+//#define BENCH_GC
+//#define BENCH_STARTUP
+//#define BENCH_MEMO
+//#define BENCH_THUMB
 
 std::string pixelTypeStr(jint pixelType)
 {
@@ -59,9 +67,21 @@ int main(int argc, char* argv[])
 
     const char* filePath = argv[1];
 
+#ifdef BENCH_STARTUP
+    auto startup = std::chrono::steady_clock::now();
+#endif
+
     auto* jvm_wrapper = JVMWrapper::getInstance();
     auto* env = jvm_wrapper->getJNIEnv();
 
+#ifdef BENCH_GC
+    // compare runs with e.g. `BIOIMREAD_JVM_GC=Parallel BIOIMREAD_JVM_MAX_HEAP=2g`
+    std::cout << "JVM options:";
+    for (auto const& arg : JVMWrapper::getOptions().toArgs())
+        std::cout << " " << arg;
+    std::cout << std::endl;
+#endif
+
     // set log level
     // https://bio-formats.readthedocs.io/en/v8.0.0/developers/logging.html
     jclass log_cls = env->FindClass("org/slf4j/Logger");
@@ -112,6 +132,34 @@ int main(int argc, char* argv[])
         jvm_wrapper->destroyJVM();
         exit(EXIT_FAILURE);
     }
+
+#ifdef BENCH_MEMO
+    {
+        // `setId` on fresh instances: without memo, with an empty memo directory (parse + serialize),
+        // then reusing it (deserialize), the file and its format classes are already warm from the `setId` above
+        auto memo_dir = (std::filesystem::temp_directory_path() / "bioimread_memo_bench").string();
+        std::filesystem::remove_all(memo_dir);
+        jmethodID setMemoDirectoryMethod = env->GetMethodID(wrapper_cls, "setMemoDirectory", "(Ljava/lang/String;)Z");
+        jmethodID closeMethod = env->GetMethodID(wrapper_cls, "close", "()V");
+        jstring memoDirJava = env->NewStringUTF(memo_dir.c_str());
+        auto open = [&](char const* name, bool memo) {
+            jobject instance = env->NewObject(wrapper_cls, constructor);
+            if (memo) env->CallBooleanMethod(instance, setMemoDirectoryMethod, memoDirJava);
+            {
+                TIME_BLOCK(name);
+                env->CallBooleanMethod(instance, setIdMethod, filePathJava);
+            }
+            env->CallVoidMethod(instance, closeMethod);
+            env->DeleteLocalRef(instance);
+        };
+        open("setId without memo", false);
+        open("setId cold memo", true);
+        open("setId warm memo", true);
+        env->DeleteLocalRef(memoDirJava);
+        std::filesystem::remove_all(memo_dir);
+    }
+#endif
+
     env->DeleteLocalRef(filePathJava);
 
     // getMetadata
@@ -210,6 +258,140 @@ int main(int argc, char* argv[])
     jint planeSize = env->CallIntMethod(wrapper_instance, getPlaneSizeMethod);
     std::cout << "getPlaneSize: " << planeSize << std::endl;
 
+#ifdef BENCH_STARTUP
+    {
+        // JVM creation + class loading + `setId` + first plane, run once with the archive dumped by the
+        // `bfwrapper_cds` target and once with `BIOIMREAD_JVM_CDS_ARCHIVE=none`
+        jmethodID openPlaneMethod = env->GetMethodID(wrapper_cls, "openPlane", "(I)[B");
+        auto plane = (jbyteArray)env->CallObjectMethod(wrapper_instance, openPlaneMethod, 0);
+        env->DeleteLocalRef(plane);
+        auto elapsed = std::chrono::steady_clock::now() - startup;
+        auto archive = JVMWrapper::getOptions().cds_archive;
+        std::cout << "time to first plane: " << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << " ms, CDS archive: " << (archive.empty() ? "none" : archive) << std::endl;
+        jvm_wrapper->destroyJVM();
+        return 0;
+    }
+#endif
+
+#ifdef BENCH_MID
+    {
+        // per-call `GetMethodID` lookup (what `Reader::impl` used to do) vs cached `jmethodID`
+        constexpr int N = 1000000;
+        auto per_call = [](auto&& f) {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < N; i++)
+                f();
+            auto d = std::chrono::high_resolution_clock::now() - start;
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() / double(N);
+        };
+        jint sink{};
+        auto lookup_ns = per_call([&] {
+            sink += env->CallIntMethod(wrapper_instance, env->GetMethodID(wrapper_cls, "getSizeX", "()I"));
+        });
+        auto cached_ns = per_call([&] { sink += env->CallIntMethod(wrapper_instance, getSizeXMethod); });
+        // 4 lookups like `getTile` + `getOptimalTileWidth/Height` + `getPlaneIndex` per tile
+        auto lookup_tile_ns = per_call([&] {
+            sink += env->CallIntMethod(wrapper_instance, env->GetMethodID(wrapper_cls, "getOptimalTileWidth", "()I"));
+            sink += env->CallIntMethod(wrapper_instance, env->GetMethodID(wrapper_cls, "getOptimalTileHeight", "()I"));
+            sink += env->CallIntMethod(wrapper_instance, env->GetMethodID(wrapper_cls, "getSizeX", "()I"));
+            sink += env->CallIntMethod(wrapper_instance, env->GetMethodID(wrapper_cls, "getSizeY", "()I"));
+        });
+        auto cached_tile_ns = per_call([&] {
+            sink += env->CallIntMethod(wrapper_instance, getSizeXMethod);
+            sink += env->CallIntMethod(wrapper_instance, getSizeYMethod);
+            sink += env->CallIntMethod(wrapper_instance, getSizeXMethod);
+            sink += env->CallIntMethod(wrapper_instance, getSizeYMethod);
+        });
+        std::cout << "getSizeX per call: " << lookup_ns << " ns with GetMethodID, " << cached_ns
+                  << " ns with cached jmethodID" << std::endl;
+        std::cout << "4 calls per tile: " << lookup_tile_ns << " ns with GetMethodID, " << cached_tile_ns
+                  << " ns with cached jmethodID" << " (" << sink << ")" << std::endl;
+    }
+#endif
+
+#ifdef BENCH_THUMB
+    {
+        // Bio-Formats `openThumbBytes` against the plane it scales down (`Reader::getThumbnail` reads the
+        // coarsest resolution covering the thumbnail instead, by bands of rows)
+        jmethodID openThumbBytesMethod = env->GetMethodID(wrapper_cls, "openThumbBytes", "(I)[B");
+        jmethodID openPlaneMethod = env->GetMethodID(wrapper_cls, "openPlane", "(I)[B");
+        for (int i = 0; i < 3; i++)
+        {
+            {
+                TIME_BLOCK("openThumbBytes");
+                env->DeleteLocalRef(env->CallObjectMethod(wrapper_instance, openThumbBytesMethod, 0));
+            }
+            {
+                TIME_BLOCK("openPlane");
+                env->DeleteLocalRef(env->CallObjectMethod(wrapper_instance, openPlaneMethod, 0));
+            }
+        }
+    }
+#endif
+
+#ifdef BENCH_KERNEL
+    // Java `openPlane` (per-sample reorder) vs raw `openBytesInto` + `planarToInterleaved`/`byteSwap`,
+    // run with fake files to cover the pixel types, e.g.
+    // `rgb&sizeX=2048&sizeY=2048&sizeZ=16&pixelType=uint8&sizeC=3&rgb=3&interleaved=false.fake`
+    // and `pixelType=uint16`/`pixelType=float`, `little=false` exercises the byte swap
+    {
+        jmethodID openPlaneMethod = env->GetMethodID(wrapper_cls, "openPlane", "(I)[B");
+        jmethodID openBytesIntoMethod =
+            env->GetMethodID(wrapper_cls, "openBytesInto", "(IIIIILjava/nio/ByteBuffer;)Z");
+        jboolean little =
+            env->CallBooleanMethod(wrapper_instance, env->GetMethodID(wrapper_cls, "isLittleEndian", "()Z"));
+        jboolean interleaved =
+            env->CallBooleanMethod(wrapper_instance, env->GetMethodID(wrapper_cls, "isInterleaved", "()Z"));
+        std::cout << "isLittleEndian: " << bool(little) << ", isInterleaved: " << bool(interleaved) << std::endl;
+
+        auto java_out = std::make_unique<std::byte[]>(planeSize);
+        auto raw = std::make_unique<std::byte[]>(planeSize);
+        auto native_out = std::make_unique<std::byte[]>(planeSize);
+        jobject dbb = env->NewDirectByteBuffer(raw.get(), planeSize);
+
+        auto swap = bytesPerPixel > 1 && !little;
+        auto planar = channelCount > 1 && !interleaved;
+        auto pixels = static_cast<std::size_t>(sizeX) * sizeY;
+        auto reorder = [&] {
+            if (planar)
+                planarToInterleaved(raw.get(), native_out.get(), pixels, channelCount, bytesPerPixel, swap);
+            else
+            {
+                std::memcpy(native_out.get(), raw.get(), planeSize);
+                if (swap) byteSwap(native_out.get(), pixels * channelCount, bytesPerPixel);
+            }
+        };
+        int n = std::min<int>(planes, 16);
+        {
+            TIME_BLOCK("java openPlane");
+            for (int i = 0; i < n; i++)
+            {
+                auto byteArray = (jbyteArray)env->CallObjectMethod(wrapper_instance, openPlaneMethod, i);
+                env->GetByteArrayRegion(byteArray, 0, planeSize, (jbyte*)java_out.get());
+                env->DeleteLocalRef(byteArray);
+            }
+        }
+        {
+            TIME_BLOCK("openBytesInto + native reorder");
+            for (int i = 0; i < n; i++)
+            {
+                env->CallBooleanMethod(wrapper_instance, openBytesIntoMethod, i, 0, 0, sizeX, sizeY, dbb);
+                reorder();
+            }
+        }
+        {
+            TIME_BLOCK("native reorder only");
+            for (int i = 0; i < n; i++)
+                reorder();
+        }
+        // both paths ended on plane `n - 1`
+        std::cout << "outputs " << (std::memcmp(java_out.get(), native_out.get(), planeSize) == 0 ? "match" : "differ")
+                  << std::endl;
+        env->DeleteLocalRef(dbb);
+    }
+#endif
+
     std::vector<std::array<int, 4>> cc(sizeC);
     // getChannelColor()
     jmethodID getChannelColorMethod = env->GetMethodID(wrapper_cls, "getChannelColor", "(I)[I");
@@ -300,6 +482,9 @@ int main(int argc, char* argv[])
 
         int cv_type = pixelType2CVType(pixelType);
 
+#ifdef BENCH_GC
+        auto gc_before = JVMWrapper::getGCStats();
+#endif
         // use openPlane to eliminate endian problem
         {
             TIME_BLOCK("openPlane");
@@ -382,6 +567,11 @@ int main(int argc, char* argv[])
 
         delete[] bytes;
         std::cout << "read " << total_bytes << " bytes with openBytes" << std::endl;
+#ifdef BENCH_GC
+        auto gc_after = JVMWrapper::getGCStats();
+        std::cout << "GC: " << gc_after.collections - gc_before.collections << " collections, "
+                  << gc_after.pause_ms - gc_before.pause_ms << " ms" << std::endl;
+#endif
     }
 #endif
 
@@ -1,14 +1,22 @@
 #include "reader.hpp"
 
 #include "jvmwrapper.hpp"
+#include "interleave.hpp"
+#include "thumbnail.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <unordered_map>
 
 struct Reader::impl
 {
     JVMWrapper* jvm_wrapper = nullptr;
-    JNIEnv* jvm_env = nullptr;
+    // looked up per call, a `Reader` may be used from other threads than the one it was created on
+    JNIEnv* jvm_env() const { return JVMWrapper::getJNIEnv(); }
     jclass wrapper_cls = nullptr;       // global reference
     jobject wrapper_instance = nullptr; // global reference
     jclass system_cls = nullptr;        // global reference
@@ -29,22 +37,90 @@ struct Reader::impl
         double physical_size_t{};
         Reader::PixelType pixel_type{};
         int rgb_channel_count{};
+        bool little_endian{true};
+        bool interleaved{};
         std::vector<std::optional<std::array<int, 4>>> channel_colors{};
         int plane_size{};
         int bits_per_pixel{};
+        // `setSeries` goes back to the full resolution
+        int resolution{};
 
-        std::string xml;
+        // OME-XML of the whole file, dumped on the first `getMetaXML`
+        std::optional<std::string> xml;
 
         void PrintSelf() const;
     };
     meta m_meta{};
+    // `getSeriesMetadata` per series, cleared with the file
+    std::unordered_map<int, Reader::MetadataFields> m_series_metadata{};
+
+    // raw planar `openBytes` output waiting for `planarToInterleaved`
+    std::vector<std::byte> m_scratch{};
+    // opened file, thumbnails are cached under it
+    std::string m_path{};
+    std::optional<ThumbnailCache> m_thumbnail_cache{};
+
+    // resolved once in `initMethods`, `GetMethodID` is a string lookup and costs more than the call itself
+    struct methods
+    {
+        jmethodID ctor{};
+        jmethodID setFlattenedResolutions{};
+        jmethodID setMemoDirectory{};
+        jmethodID setId{};
+        jmethodID close{};
+        jmethodID reopenFile{};
+        jmethodID setSeries{};
+        jmethodID getOMEXML{};
+        jmethodID getImageCount{};
+        jmethodID getSeriesCount{};
+        jmethodID getSeries{};
+        jmethodID getSizeX{};
+        jmethodID getSizeY{};
+        jmethodID getSizeZ{};
+        jmethodID getEffectiveSizeC{};
+        jmethodID getSizeT{};
+        jmethodID getPhysSizeX{};
+        jmethodID getPhysSizeY{};
+        jmethodID getPhysSizeZ{};
+        jmethodID getPhysSizeT{};
+        jmethodID getPixelType{};
+        jmethodID getRGBChannelCount{};
+        jmethodID isLittleEndian{};
+        jmethodID isInterleaved{};
+        jmethodID getChannelColor{};
+        jmethodID getPlaneSize{};
+        jmethodID getPlaneIndex{};
+        jmethodID getZCTCoords{};
+        jmethodID openPlane{};
+        jmethodID get8BitLookupTable{};
+        jmethodID get16BitLookupTable{};
+        jmethodID getBitsPerPixel{};
+        jmethodID getOptimalTileWidth{};
+        jmethodID getOptimalTileHeight{};
+        jmethodID openBytes{};
+        jmethodID openBytesInto{};
+        jmethodID openPlanes{};
+        jmethodID getResolutionCount{};
+        jmethodID setResolution{};
+        jmethodID getSeriesInfo{};
+        jmethodID getSeriesMetadata{};
+        jmethodID gc{}; // static, `java/lang/System`
+    };
+    methods m_methods{};
+
+    bool initMethods();
 
     void setFlattenedResolutions(bool flag);
+    bool setMemoDirectory(std::string const& directory);
+    void setThumbnailDirectory(std::string const& directory);
     bool open(std::string filePath);
     void close();
     bool reopen();
     void setSeries(int no);
+    // refreshes `m_meta` of the current series / resolution with a single `getSeriesInfo` call
+    void readSeriesInfo();
     std::string getXML();
+    Reader::MetadataFields getSeriesMetadata(int series);
     int getImageCount();
     int getSeriesCount();
     int getSeries();
@@ -69,6 +145,14 @@ struct Reader::impl
     int getPlaneIndex(int z, int c, int t);
     std::array<int, 3> getZCTCoords(int index);
     std::unique_ptr<char[]> getPlane(int no);
+    bool readPlaneInto(int no, std::span<std::byte> dst);
+    bool readPlanes(std::span<int const> nos, std::span<std::byte> dst);
+    // raw `openBytes` layout of a plane or region -> interleaved little endian, `raw` may be `dst` itself
+    void reorderPlane(std::span<std::byte> raw, std::span<std::byte> dst);
+    std::optional<Reader::Thumbnail> getThumbnail(int no, int max_size);
+    std::vector<Reader::Thumbnail> getSeriesThumbnails(int max_size);
+    // plane `no` of the current resolution area averaged to fit in `max_size`, read by bands of rows
+    std::optional<Reader::Thumbnail> downscalePlane(int no, int max_size);
     std::unique_ptr<std::vector<std::array<unsigned char, 3>>> get8BitLut();
     std::unique_ptr<std::vector<std::array<short, 3>>> get16BitLut();
     int getBitsPerPixel();
@@ -76,41 +160,61 @@ struct Reader::impl
     int getOptimalTileWidth() const;
     int getOptimalTileHeight() const;
     std::unique_ptr<char[]> getTile(int no, int x, int y, int w, int h) const;
+    bool readTileInto(int no, int x, int y, int w, int h, std::span<std::byte> dst) const;
+    std::unique_ptr<char[]> getRegion(int no, int x, int y, int w, int h);
+    bool readRegionInto(int no, int x, int y, int w, int h, std::span<std::byte> dst);
 
     int getResolutionCount() const;
     void setResolution(int level);
 
     void force_gc();
+    // of a failed construction or of the destructor
+    void deleteGlobalRefs();
 };
 
 Reader::Reader()
 {
     pimpl = std::make_unique<impl>();
+    // failures below leave the JVM up, it is shared with the other readers (pools, servers)
     pimpl->jvm_wrapper = JVMWrapper::getInstance();
-    pimpl->jvm_env = pimpl->jvm_wrapper->getJNIEnv();
+    if (pimpl->jvm_wrapper == nullptr)
+    {
+        std::cerr << "Error: failed to create the JVM." << std::endl;
+        pimpl = nullptr;
+        return;
+    }
     pimpl->wrapper_cls = pimpl->jvm_wrapper->findClass("bfwrapper");
     if (pimpl->wrapper_cls == nullptr)
     {
         std::cerr << "Error: bfwrapper Class not found." << std::endl;
-        pimpl->jvm_wrapper->destroyJVM();
+        pimpl->deleteGlobalRefs();
         pimpl = nullptr;
         return;
     }
     pimpl->system_cls = pimpl->jvm_wrapper->findClass("java/lang/System");
-    if (auto local_ref = pimpl->jvm_env->NewObject(
-            pimpl->wrapper_cls, pimpl->jvm_wrapper->getMethodID(pimpl->wrapper_cls, "<init>", "()V"));
-        local_ref)
+    if (!pimpl->initMethods())
     {
-        pimpl->wrapper_instance = pimpl->jvm_env->NewGlobalRef(local_ref);
-        pimpl->jvm_env->DeleteLocalRef(local_ref);
+        std::cerr << "Error: bfwrapper Class methods not found." << std::endl;
+        pimpl->deleteGlobalRefs();
+        pimpl = nullptr;
+        return;
+    }
+    if (auto local_ref = pimpl->jvm_env()->NewObject(pimpl->wrapper_cls, pimpl->m_methods.ctor); local_ref)
+    {
+        pimpl->wrapper_instance = pimpl->jvm_env()->NewGlobalRef(local_ref);
+        pimpl->jvm_env()->DeleteLocalRef(local_ref);
     }
     else
     {
         std::cerr << "Error: bfwrapper Class instance can not be created." << std::endl;
-        pimpl->jvm_wrapper->destroyJVM();
+        pimpl->deleteGlobalRefs();
         pimpl = nullptr;
         return;
     }
+    if (auto* memo_dir = std::getenv("BIOIMREAD_MEMO_DIR"); memo_dir && *memo_dir)
+        pimpl->setMemoDirectory(memo_dir);
+    if (auto* thumbnail_dir = std::getenv("BIOIMREAD_THUMBNAIL_DIR"); thumbnail_dir && *thumbnail_dir)
+        pimpl->setThumbnailDirectory(thumbnail_dir);
 }
 
 Reader::~Reader()
@@ -118,21 +222,40 @@ Reader::~Reader()
     if (pimpl)
     {
         close();
-        pimpl->jvm_env->DeleteGlobalRef(pimpl->wrapper_cls);
-        pimpl->jvm_env->DeleteGlobalRef(pimpl->wrapper_instance);
-        pimpl->jvm_env->DeleteGlobalRef(pimpl->system_cls);
-        pimpl->wrapper_cls = nullptr;
-        pimpl->wrapper_instance = nullptr;
-        pimpl->system_cls = nullptr;
+        pimpl->deleteGlobalRefs();
     }
     pimpl = nullptr;
 }
 
+void Reader::impl::deleteGlobalRefs()
+{
+    if (auto* env = jvm_env())
+    {
+        if (wrapper_cls) env->DeleteGlobalRef(wrapper_cls);
+        if (wrapper_instance) env->DeleteGlobalRef(wrapper_instance);
+        if (system_cls) env->DeleteGlobalRef(system_cls);
+    }
+    wrapper_cls = nullptr;
+    wrapper_instance = nullptr;
+    system_cls = nullptr;
+}
+
 void Reader::setFlattenedResolutions(bool flag)
 {
     pimpl->setFlattenedResolutions(flag);
 }
 
+bool Reader::setMemoDirectory(std::string directory)
+{
+    if (!pimpl) return false;
+    return pimpl->setMemoDirectory(directory);
+}
+
+void Reader::setThumbnailDirectory(std::string directory)
+{
+    if (pimpl) pimpl->setThumbnailDirectory(directory);
+}
+
 bool Reader::open(std::string filePath)
 {
     if (!pimpl) return false;
@@ -157,7 +280,16 @@ void Reader::setSeries(int no)
 
 std::string Reader::getMetaXML() const
 {
-    return pimpl->m_meta.xml;
+    if (!pimpl->m_meta.xml) pimpl->m_meta.xml = pimpl->getXML();
+    return *pimpl->m_meta.xml;
+}
+
+Reader::MetadataFields Reader::getSeriesMetadata(int series) const
+{
+    auto it = pimpl->m_series_metadata.find(series);
+    if (it == pimpl->m_series_metadata.end())
+        it = pimpl->m_series_metadata.emplace(series, pimpl->getSeriesMetadata(series)).first;
+    return it->second;
 }
 
 int Reader::getImageCount() const
@@ -265,6 +397,26 @@ std::unique_ptr<char[]> Reader::getPlane(int no) const
     return pimpl->getPlane(no);
 }
 
+bool Reader::readPlaneInto(int no, std::span<std::byte> dst) const
+{
+    return pimpl->readPlaneInto(no, dst);
+}
+
+bool Reader::readPlanes(std::span<int const> nos, std::span<std::byte> dst) const
+{
+    return pimpl->readPlanes(nos, dst);
+}
+
+std::optional<Reader::Thumbnail> Reader::getThumbnail(int no, int max_size) const
+{
+    return pimpl->getThumbnail(no, max_size);
+}
+
+std::vector<Reader::Thumbnail> Reader::getSeriesThumbnails(int max_size) const
+{
+    return pimpl->getSeriesThumbnails(max_size);
+}
+
 std::unique_ptr<std::vector<std::array<unsigned char, 3>>> Reader::get8BitLut() const
 {
     return pimpl->get8BitLut();
@@ -290,6 +442,21 @@ std::unique_ptr<char[]> Reader::getTile(int no, int x, int y, int w, int h) cons
     return pimpl->getTile(no, x, y, w, h);
 }
 
+bool Reader::readTileInto(int no, int x, int y, int w, int h, std::span<std::byte> dst) const
+{
+    return pimpl->readTileInto(no, x, y, w, h, dst);
+}
+
+std::unique_ptr<char[]> Reader::getRegion(int no, int x, int y, int w, int h) const
+{
+    return pimpl->getRegion(no, x, y, w, h);
+}
+
+bool Reader::readRegionInto(int no, int x, int y, int w, int h, std::span<std::byte> dst) const
+{
+    return pimpl->readRegionInto(no, x, y, w, h, dst);
+}
+
 int Reader::getResolutionCount() const
 {
     return pimpl->getResolutionCount();
@@ -346,33 +513,111 @@ void Reader::impl::meta::PrintSelf() const
               << "\nrgb_channel_count: " << rgb_channel_count << "\nplane_size: " << plane_size << "\n";
 }
 
+bool Reader::impl::initMethods()
+{
+    auto& m = m_methods;
+    bool found = true;
+    auto get = [&](const char* name, const char* sig, jclass cls = nullptr, bool is_static = false) {
+        auto id = jvm_wrapper->getMethodID(cls ? cls : wrapper_cls, name, sig, is_static);
+        found &= (id != nullptr);
+        return id;
+    };
+
+    m.ctor = get("<init>", "()V");
+    m.setFlattenedResolutions = get("setFlattenedResolutions", "(Z)V");
+    m.setMemoDirectory = get("setMemoDirectory", "(Ljava/lang/String;)Z");
+    m.setId = get("setId", "(Ljava/lang/String;)Z");
+    m.close = get("close", "()V");
+    m.reopenFile = get("reopenFile", "()Z");
+    m.setSeries = get("setSeries", "(I)V");
+    m.getOMEXML = get("getOMEXML", "()Ljava/lang/String;");
+    m.getImageCount = get("getImageCount", "()I");
+    m.getSeriesCount = get("getSeriesCount", "()I");
+    m.getSeries = get("getSeries", "()I");
+    m.getSizeX = get("getSizeX", "()I");
+    m.getSizeY = get("getSizeY", "()I");
+    m.getSizeZ = get("getSizeZ", "()I");
+    m.getEffectiveSizeC = get("getEffectiveSizeC", "()I");
+    m.getSizeT = get("getSizeT", "()I");
+    m.getPhysSizeX = get("getPhysSizeX", "()D");
+    m.getPhysSizeY = get("getPhysSizeY", "()D");
+    m.getPhysSizeZ = get("getPhysSizeZ", "()D");
+    m.getPhysSizeT = get("getPhysSizeT", "()D");
+    m.getPixelType = get("getPixelType", "()I");
+    m.getRGBChannelCount = get("getRGBChannelCount", "()I");
+    m.isLittleEndian = get("isLittleEndian", "()Z");
+    m.isInterleaved = get("isInterleaved", "()Z");
+    m.getChannelColor = get("getChannelColor", "(I)[I");
+    m.getPlaneSize = get("getPlaneSize", "()I");
+    m.getPlaneIndex = get("getPlaneIndex", "(III)I");
+    m.getZCTCoords = get("getZCTCoords", "(I)[I");
+    m.openPlane = get("openPlane", "(I)[B");
+    m.get8BitLookupTable = get("get8BitLookupTable", "()[[B");
+    m.get16BitLookupTable = get("get16BitLookupTable", "()[[S");
+    m.getBitsPerPixel = get("getBitsPerPixel", "()I");
+    m.getOptimalTileWidth = get("getOptimalTileWidth", "()I");
+    m.getOptimalTileHeight = get("getOptimalTileHeight", "()I");
+    m.openBytes = get("openBytes", "(IIIII)[B");
+    m.openBytesInto = get("openBytesInto", "(IIIIILjava/nio/ByteBuffer;)Z");
+    m.openPlanes = get("openPlanes", "([ILjava/nio/ByteBuffer;)Z");
+    m.getResolutionCount = get("getResolutionCount", "()I");
+    m.setResolution = get("setResolution", "(I)V");
+    m.getSeriesInfo = get("getSeriesInfo", "()[D");
+    m.getSeriesMetadata = get("getSeriesMetadata", "(I)[Ljava/lang/String;");
+    m.gc = get("gc", "()V", system_cls, true);
+
+    return found;
+}
+
 void Reader::impl::setFlattenedResolutions(bool flag)
 {
-    jvm_env->CallVoidMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "setFlattenedResolutions", "(Z)V"),
-                            flag);
+    jvm_env()->CallVoidMethod(wrapper_instance, m_methods.setFlattenedResolutions, flag);
+}
+
+bool Reader::impl::setMemoDirectory(std::string const& directory)
+{
+    jstring directoryJava = jvm_env()->NewStringUTF(directory.c_str());
+    auto res = jvm_env()->CallBooleanMethod(wrapper_instance, m_methods.setMemoDirectory, directoryJava);
+    jvm_env()->DeleteLocalRef(directoryJava);
+    m_meta.series = -1;
+    m_meta.xml.reset();
+    m_series_metadata.clear();
+    if (!res) std::cerr << "Error: memo directory " << directory << " can not be used" << std::endl;
+    return res;
+}
+
+void Reader::impl::setThumbnailDirectory(std::string const& directory)
+{
+    if (directory.empty())
+        m_thumbnail_cache.reset();
+    else
+        m_thumbnail_cache.emplace(directory);
 }
 
 bool Reader::impl::open(std::string filePath)
 {
-    jstring filePathJava = jvm_env->NewStringUTF(filePath.c_str());
-    auto res = jvm_env->CallBooleanMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "setId", "(Ljava/lang/String;)Z"), filePathJava);
-    jvm_env->DeleteLocalRef(filePathJava);
+    jstring filePathJava = jvm_env()->NewStringUTF(filePath.c_str());
+    auto res = jvm_env()->CallBooleanMethod(wrapper_instance, m_methods.setId, filePathJava);
+    jvm_env()->DeleteLocalRef(filePathJava);
+    m_meta.xml.reset();
+    m_series_metadata.clear();
     if (res) m_meta.series_count = getSeriesCount();
+    m_path = res ? std::move(filePath) : std::string{};
     return res;
 }
 
 void Reader::impl::close()
 {
-    jvm_env->CallVoidMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "close", "()V"));
+    jvm_env()->CallVoidMethod(wrapper_instance, m_methods.close);
+    m_path.clear();
     m_meta.series = -1;
+    m_meta.xml.reset();
+    m_series_metadata.clear();
 }
 
 bool Reader::impl::reopen()
 {
-    if (auto res =
-            jvm_env->CallBooleanMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "reopenFile", "()Z"));
-        !res)
+    if (auto res = jvm_env()->CallBooleanMethod(wrapper_instance, m_methods.reopenFile); !res)
         return false;
     else
     {
@@ -389,115 +634,182 @@ void Reader::impl::setSeries(int no)
         return;
     }
     if (m_meta.series == no) return;
-    jvm_env->CallVoidMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "setSeries", "(I)V"), no);
+    jvm_env()->CallVoidMethod(wrapper_instance, m_methods.setSeries, no);
     m_meta.series = no;
-    m_meta.image_count = getImageCount();
-    m_meta.size_x = getSizeX();
-    m_meta.size_y = getSizeY();
-    m_meta.size_z = getSizeZ();
-    m_meta.size_t = getSizeT();
-    m_meta.size_c = getSizeC();
-    m_meta.physical_size_x = getPhysSizeX();
-    m_meta.physical_size_y = getPhysSizeY();
-    m_meta.physical_size_z = getPhysSizeZ();
-    m_meta.physical_size_t = getPhysSizeT();
-    m_meta.pixel_type = getPixelType();
-    m_meta.rgb_channel_count = getRGBChannelCount();
-    m_meta.channel_colors.resize(m_meta.size_c);
-    for (auto c = 0; c < m_meta.size_c; c++)
-        m_meta.channel_colors[c] = getChannelColor(c);
-    m_meta.plane_size = getPlaneSize();
-    m_meta.bits_per_pixel = getBitsPerPixel();
-
-    m_meta.xml = getXML();
+    m_meta.resolution = 0;
+    readSeriesInfo();
 }
 
-std::string Reader::impl::getXML()
+void Reader::impl::readSeriesInfo()
 {
-    jstring xmldata = (jstring)jvm_env->CallObjectMethod(
-        wrapper_instance, jvm_env->GetMethodID(wrapper_cls, "getOMEXML", "()Ljava/lang/String;"));
-    if (xmldata != nullptr)
+    // `bfwrapper.getSeriesInfo` layout
+    enum SeriesInfo : int
+    {
+        ImageCount = 0,
+        SizeX,
+        SizeY,
+        SizeZ,
+        SizeC,
+        SizeT,
+        PhysSizeX,
+        PhysSizeY,
+        PhysSizeZ,
+        PhysSizeT,
+        PixelType,
+        RGBChannelCount,
+        LittleEndian,
+        Interleaved,
+        PlaneSize,
+        BitsPerPixel,
+        ChannelColors // r, g, b, a per channel
+    };
+
+    auto info_array = (jdoubleArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.getSeriesInfo);
+    if (info_array == nullptr)
     {
-        const char* xmldataChars = jvm_env->GetStringUTFChars(xmldata, nullptr);
-        std::string xml = std::string(xmldataChars);
-        jvm_env->ReleaseStringUTFChars(xmldata, xmldataChars);
-        return xml;
+        std::cerr << "Error retrieving series info" << std::endl;
+        return;
     }
-    else
+    std::vector<double> info(jvm_env()->GetArrayLength(info_array));
+    jvm_env()->GetDoubleArrayRegion(info_array, 0, static_cast<jsize>(info.size()), info.data());
+    jvm_env()->DeleteLocalRef(info_array);
+    if (info.size() < ChannelColors) return;
+
+    auto as_int = [&](SeriesInfo field) { return static_cast<int>(info[field]); };
+    m_meta.image_count = as_int(ImageCount);
+    m_meta.size_x = as_int(SizeX);
+    m_meta.size_y = as_int(SizeY);
+    m_meta.size_z = as_int(SizeZ);
+    m_meta.size_c = as_int(SizeC);
+    m_meta.size_t = as_int(SizeT);
+    m_meta.physical_size_x = info[PhysSizeX];
+    m_meta.physical_size_y = info[PhysSizeY];
+    m_meta.physical_size_z = info[PhysSizeZ];
+    m_meta.physical_size_t = info[PhysSizeT];
+    m_meta.pixel_type = static_cast<Reader::PixelType>(as_int(PixelType));
+    m_meta.rgb_channel_count = as_int(RGBChannelCount);
+    m_meta.little_endian = info[LittleEndian] != 0;
+    m_meta.interleaved = info[Interleaved] != 0;
+    m_meta.plane_size = as_int(PlaneSize);
+    m_meta.bits_per_pixel = as_int(BitsPerPixel);
+    m_meta.channel_colors.assign(m_meta.size_c, std::nullopt);
+    for (std::size_t c = 0; c < m_meta.channel_colors.size() && ChannelColors + 4 * c + 3 < info.size(); c++)
+    {
+        auto* rgba = &info[ChannelColors + 4 * c];
+        if (rgba[0] >= 0)
+            m_meta.channel_colors[c] = std::array<int, 4>{static_cast<int>(rgba[0]), static_cast<int>(rgba[1]),
+                                                          static_cast<int>(rgba[2]), static_cast<int>(rgba[3])};
+    }
+}
+
+std::string Reader::impl::getXML()
+{
+    jstring xmldata = (jstring)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.getOMEXML);
+    if (xmldata == nullptr)
+    {
         std::cerr << "Error retrieving xmldata" << std::endl;
-    jvm_env->DeleteLocalRef(xmldata);
-    return {};
+        return {};
+    }
+    const char* xmldataChars = jvm_env()->GetStringUTFChars(xmldata, nullptr);
+    std::string xml = std::string(xmldataChars);
+    jvm_env()->ReleaseStringUTFChars(xmldata, xmldataChars);
+    jvm_env()->DeleteLocalRef(xmldata);
+    return xml;
+}
+
+Reader::MetadataFields Reader::impl::getSeriesMetadata(int series)
+{
+    Reader::MetadataFields fields;
+    auto kv = (jobjectArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.getSeriesMetadata, series);
+    if (kv == nullptr)
+    {
+        std::cerr << "Error retrieving series " << series << " metadata" << std::endl;
+        return fields;
+    }
+    auto to_string = [&](jsize i) {
+        auto str = (jstring)jvm_env()->GetObjectArrayElement(kv, i);
+        const char* chars = jvm_env()->GetStringUTFChars(str, nullptr);
+        std::string res(chars);
+        jvm_env()->ReleaseStringUTFChars(str, chars);
+        jvm_env()->DeleteLocalRef(str);
+        return res;
+    };
+    auto len = jvm_env()->GetArrayLength(kv);
+    fields.reserve(len / 2);
+    for (jsize i = 0; i + 1 < len; i += 2)
+        fields.emplace_back(to_string(i), to_string(i + 1));
+    jvm_env()->DeleteLocalRef(kv);
+    return fields;
 }
 
 int Reader::impl::getImageCount()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getImageCount", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getImageCount);
 }
 
 int Reader::impl::getSeriesCount()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getSeriesCount", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getSeriesCount);
 }
 
 int Reader::impl::getSeries()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getSeries", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getSeries);
 }
 
 int Reader::impl::getSizeX()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getSizeX", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getSizeX);
 }
 
 int Reader::impl::getSizeY()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getSizeY", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getSizeY);
 }
 
 int Reader::impl::getSizeZ()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getSizeZ", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getSizeZ);
 }
 
 int Reader::impl::getSizeC()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getEffectiveSizeC", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getEffectiveSizeC);
 }
 
 int Reader::impl::getSizeT()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getSizeT", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getSizeT);
 }
 
 double Reader::impl::getPhysSizeX()
 {
-    return jvm_env->CallDoubleMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPhysSizeX", "()D"));
+    return jvm_env()->CallDoubleMethod(wrapper_instance, m_methods.getPhysSizeX);
 }
 
 double Reader::impl::getPhysSizeY()
 {
-    return jvm_env->CallDoubleMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPhysSizeY", "()D"));
+    return jvm_env()->CallDoubleMethod(wrapper_instance, m_methods.getPhysSizeY);
 }
 
 double Reader::impl::getPhysSizeZ()
 {
-    return jvm_env->CallDoubleMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPhysSizeZ", "()D"));
+    return jvm_env()->CallDoubleMethod(wrapper_instance, m_methods.getPhysSizeZ);
 }
 
 double Reader::impl::getPhysSizeT()
 {
-    return jvm_env->CallDoubleMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPhysSizeT", "()D"));
+    return jvm_env()->CallDoubleMethod(wrapper_instance, m_methods.getPhysSizeT);
 }
 
 Reader::PixelType Reader::impl::getPixelType()
 {
-    return static_cast<Reader::PixelType>(
-        jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPixelType", "()I")));
+    return static_cast<Reader::PixelType>(jvm_env()->CallIntMethod(wrapper_instance, m_methods.getPixelType));
 }
 
 int Reader::impl::getRGBChannelCount()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getRGBChannelCount", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getRGBChannelCount);
 }
 
 std::optional<std::array<int, 4>> Reader::impl::getChannelColor(int channel)
@@ -506,31 +818,30 @@ std::optional<std::array<int, 4>> Reader::impl::getChannelColor(int channel)
 
     std::optional<std::array<int, 4>> res;
 
-    jintArray channelColor = (jintArray)jvm_env->CallObjectMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getChannelColor", "(I)[I"), channel);
+    jintArray channelColor =
+        (jintArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.getChannelColor, channel);
     if (channelColor != nullptr)
     {
-        jsize len = jvm_env->GetArrayLength(channelColor);
+        jsize len = jvm_env()->GetArrayLength(channelColor);
         if (len == 4)
         {
             std::array<int, 4> color{};
-            jvm_env->GetIntArrayRegion(channelColor, 0, len, (jint*)color.data());
+            jvm_env()->GetIntArrayRegion(channelColor, 0, len, (jint*)color.data());
             res = color;
         }
     }
-    jvm_env->DeleteLocalRef(channelColor);
+    jvm_env()->DeleteLocalRef(channelColor);
     return res;
 }
 
 int Reader::impl::getPlaneSize()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPlaneSize", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getPlaneSize);
 }
 
 int Reader::impl::getPlaneIndex(int z, int c, int t)
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPlaneIndex", "(III)I"), z,
-                                  c, t);
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getPlaneIndex, z, c, t);
 }
 
 std::array<int, 3> Reader::impl::getZCTCoords(int index)
@@ -539,155 +850,323 @@ std::array<int, 3> Reader::impl::getZCTCoords(int index)
 
     std::array<int, 3> coord{};
 
-    jintArray zct = (jintArray)jvm_env->CallObjectMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getZCTCoords", "(I)[I"), index);
+    jintArray zct = (jintArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.getZCTCoords, index);
 
     assert(zct != nullptr);
 
-    jsize len = jvm_env->GetArrayLength(zct);
+    jsize len = jvm_env()->GetArrayLength(zct);
 
     assert(len == 3);
 
-    jvm_env->GetIntArrayRegion(zct, 0, len, (jint*)coord.data());
-    jvm_env->DeleteLocalRef(zct);
+    jvm_env()->GetIntArrayRegion(zct, 0, len, (jint*)coord.data());
+    jvm_env()->DeleteLocalRef(zct);
     return coord;
 }
 
 std::unique_ptr<char[]> Reader::impl::getPlane(int no)
 {
-    jbyteArray byteArray = (jbyteArray)jvm_env->CallObjectMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "openPlane", "(I)[B"), no);
-
-    assert(byteArray != nullptr);
-
-    jsize len = jvm_env->GetArrayLength(byteArray);
-    auto bytes = std::make_unique<char[]>(sizeof(jbyte) * len);
-    jvm_env->GetByteArrayRegion(byteArray, 0, len, (jbyte*)bytes.get());
-    jvm_env->DeleteLocalRef(byteArray);
+    auto bytes = std::make_unique_for_overwrite<char[]>(m_meta.plane_size);
+    if (!readPlaneInto(no, std::as_writable_bytes(std::span(bytes.get(), m_meta.plane_size)))) return nullptr;
 
     //force_gc();  // 340M -> 170M with 11-12ms time cost (non-force: 1-2ms time cost)
 
     return bytes;
 }
 
+bool Reader::impl::readPlaneInto(int no, std::span<std::byte> dst)
+{
+    return readRegionInto(no, 0, 0, m_meta.size_x, m_meta.size_y, dst);
+}
+
+bool Reader::impl::readPlanes(std::span<int const> nos, std::span<std::byte> dst)
+{
+    auto plane_size = static_cast<std::size_t>(m_meta.plane_size);
+    if (dst.size() < nos.size() * plane_size)
+    {
+        std::cerr << "Error: buffer of " << dst.size() << " bytes is too small for " << nos.size() << " planes of "
+                  << plane_size << " bytes" << std::endl;
+        return false;
+    }
+
+    // a `ByteBuffer` is int indexed, so stacks above 2GB take more than one call
+    auto per_call = std::max<std::size_t>(1, std::numeric_limits<jint>::max() / plane_size);
+    for (std::size_t i = 0; i < nos.size(); i += per_call)
+    {
+        auto n = std::min(per_call, nos.size() - i);
+        std::vector<jint> ids(nos.begin() + i, nos.begin() + i + n);
+        auto chunk = dst.subspan(i * plane_size, n * plane_size);
+
+        jintArray ids_java = jvm_env()->NewIntArray(static_cast<jsize>(n));
+        jvm_env()->SetIntArrayRegion(ids_java, 0, static_cast<jsize>(n), ids.data());
+        jobject dbb = jvm_env()->NewDirectByteBuffer(chunk.data(), static_cast<jlong>(chunk.size()));
+        auto succeed =
+            dbb != nullptr && jvm_env()->CallBooleanMethod(wrapper_instance, m_methods.openPlanes, ids_java, dbb);
+        jvm_env()->DeleteLocalRef(dbb);
+        jvm_env()->DeleteLocalRef(ids_java);
+        if (!succeed)
+        {
+            std::cerr << "Error: failed to read planes [" << i << ", " << i + n << ")" << std::endl;
+            return false;
+        }
+    }
+
+    for (std::size_t i = 0; i < nos.size(); i++)
+    {
+        auto plane = dst.subspan(i * plane_size, plane_size);
+        reorderPlane(plane, plane);
+    }
+
+    return true;
+}
+
+void Reader::impl::reorderPlane(std::span<std::byte> raw, std::span<std::byte> dst)
+{
+    auto bpp = Reader::getBytesPerPixel(m_meta.pixel_type);
+    auto channels = m_meta.rgb_channel_count;
+    auto swap = bpp > 1 && !m_meta.little_endian;
+    auto pixels = raw.size() / (static_cast<std::size_t>(channels) * bpp);
+
+    if (channels > 1 && !m_meta.interleaved)
+    {
+        if (raw.data() == dst.data())
+        {
+            m_scratch.assign(raw.begin(), raw.end());
+            raw = m_scratch;
+        }
+        planarToInterleaved(raw.data(), dst.data(), pixels, channels, bpp, swap);
+        return;
+    }
+    if (raw.data() != dst.data()) std::copy(raw.begin(), raw.end(), dst.begin());
+    if (swap) byteSwap(dst.data(), pixels * channels, bpp);
+}
+
+std::optional<Reader::Thumbnail> Reader::impl::getThumbnail(int no, int max_size)
+{
+    if (m_path.empty() || max_size <= 0) return std::nullopt;
+    // Bio-Formats is at series 0 after `open`
+    if (m_meta.series < 0) setSeries(0);
+    if (no < 0 || no >= m_meta.image_count) return std::nullopt;
+    if (m_thumbnail_cache)
+        if (auto cached = m_thumbnail_cache->get(m_path, m_meta.series, no, max_size)) return cached;
+
+    // the coarsest resolution still covering `max_size`, pyramids hold thumbnails of a few hundred pixels
+    auto resolution = m_meta.resolution;
+    if (auto levels = getResolutionCount(); levels > 1)
+    {
+        auto level = levels - 1;
+        for (; level > 0; level--)
+        {
+            setResolution(level);
+            if (std::max(m_meta.size_x, m_meta.size_y) >= max_size) break;
+        }
+        if (level == 0) setResolution(0);
+    }
+    auto thumbnail = downscalePlane(no, max_size);
+    if (m_meta.resolution != resolution) setResolution(resolution);
+
+    if (thumbnail && m_thumbnail_cache) m_thumbnail_cache->put(m_path, *thumbnail, max_size);
+    return thumbnail;
+}
+
+std::vector<Reader::Thumbnail> Reader::impl::getSeriesThumbnails(int max_size)
+{
+    if (m_path.empty() || max_size <= 0) return {};
+    if (m_thumbnail_cache)
+        if (auto cached = m_thumbnail_cache->getSeries(m_path, max_size)) return std::move(*cached);
+
+    auto series = m_meta.series;
+    auto resolution = m_meta.resolution;
+    std::vector<Reader::Thumbnail> thumbnails;
+    for (auto s = 0; s < m_meta.series_count; s++)
+    {
+        setSeries(s);
+        // middle section, first channel and timepoint
+        if (auto thumbnail = getThumbnail(getPlaneIndex(m_meta.size_z / 2, 0, 0), max_size))
+            thumbnails.push_back(std::move(*thumbnail));
+    }
+    // no series set yet: Bio-Formats opens files on the first one
+    setSeries(std::max(series, 0));
+    if (series >= 0 && resolution != 0) setResolution(resolution);
+
+    // a series that could not be read is tried again next time
+    if (m_thumbnail_cache && static_cast<int>(thumbnails.size()) == m_meta.series_count)
+        m_thumbnail_cache->putSeries(m_path, thumbnails, max_size);
+    return thumbnails;
+}
+
+std::optional<Reader::Thumbnail> Reader::impl::downscalePlane(int no, int max_size)
+{
+    auto width = m_meta.size_x;
+    auto height = m_meta.size_y;
+    auto channels = m_meta.rgb_channel_count;
+    auto bpp = Reader::getBytesPerPixel(m_meta.pixel_type);
+    if (width <= 0 || height <= 0 || channels <= 0) return std::nullopt;
+
+    // never upscaled
+    auto scale = std::min(1., static_cast<double>(max_size) / std::max(width, height));
+    Reader::Thumbnail thumbnail;
+    thumbnail.series = m_meta.series;
+    thumbnail.no = no;
+    thumbnail.size_x = std::max(1, static_cast<int>(std::lround(width * scale)));
+    thumbnail.size_y = std::max(1, static_cast<int>(std::lround(height * scale)));
+    thumbnail.pixel_type = m_meta.pixel_type;
+    thumbnail.rgb_channel_count = channels;
+
+    // bands of ~32MB, planes above 2GB (and their Java arrays) are never held at once
+    auto row_size = static_cast<std::size_t>(width) * channels * bpp;
+    auto band_rows = static_cast<int>(std::clamp<std::size_t>((32 << 20) / row_size, 1, height));
+    std::vector<std::byte> band(band_rows * row_size);
+    AreaDownscaler downscaler(m_meta.pixel_type, channels, width, height, thumbnail.size_x, thumbnail.size_y);
+    for (auto y = 0; y < height; y += band_rows)
+    {
+        auto rows = std::min(band_rows, height - y);
+        auto rows_span = std::span(band).first(rows * row_size);
+        if (!readRegionInto(no, 0, y, width, rows, rows_span)) return std::nullopt;
+        downscaler.addRows(y, rows, rows_span.data());
+    }
+    thumbnail.bytes = downscaler.result();
+    return thumbnail;
+}
+
 std::unique_ptr<std::vector<std::array<unsigned char, 3>>> Reader::impl::get8BitLut()
 {
     auto lut = std::make_unique<std::vector<std::array<unsigned char, 3>>>();
-    jmethodID get8BitLookupTableMethod = jvm_env->GetMethodID(wrapper_cls, "get8BitLookupTable", "()[[B");
-    jobjectArray bytesArray = (jobjectArray)jvm_env->CallObjectMethod(wrapper_instance, get8BitLookupTableMethod);
+    jobjectArray bytesArray = (jobjectArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.get8BitLookupTable);
     if (bytesArray != nullptr)
     {
-        assert(jvm_env->GetArrayLength(bytesArray) == 3); // RGB 3 channels
+        assert(jvm_env()->GetArrayLength(bytesArray) == 3); // RGB 3 channels
 
-        auto b0 = (jbyteArray)jvm_env->GetObjectArrayElement(bytesArray, 0);
-        jsize len = jvm_env->GetArrayLength(b0);
-        jvm_env->DeleteLocalRef(b0);
+        auto b0 = (jbyteArray)jvm_env()->GetObjectArrayElement(bytesArray, 0);
+        jsize len = jvm_env()->GetArrayLength(b0);
+        jvm_env()->DeleteLocalRef(b0);
         lut->resize(len);
 
         std::vector<unsigned char> buffer(len);
         for (jsize i = 0; i < 3; i++)
         {
-            jbyteArray b = (jbyteArray)jvm_env->GetObjectArrayElement(bytesArray, i);
-            jvm_env->GetByteArrayRegion(b, 0, len, (jbyte*)buffer.data());
-            jvm_env->DeleteLocalRef(b);
+            jbyteArray b = (jbyteArray)jvm_env()->GetObjectArrayElement(bytesArray, i);
+            jvm_env()->GetByteArrayRegion(b, 0, len, (jbyte*)buffer.data());
+            jvm_env()->DeleteLocalRef(b);
 
             for (auto j = 0; j < len; j++)
                 (*lut)[j][i] = buffer[j];
         }
     }
-    jvm_env->DeleteLocalRef(bytesArray);
+    jvm_env()->DeleteLocalRef(bytesArray);
     return lut;
 }
 
 std::unique_ptr<std::vector<std::array<short, 3>>> Reader::impl::get16BitLut()
 {
     auto lut = std::make_unique<std::vector<std::array<short, 3>>>();
-    jmethodID get16BitLookupTableMethod = jvm_env->GetMethodID(wrapper_cls, "get16BitLookupTable", "()[[S");
-    jobjectArray bytesArray = (jobjectArray)jvm_env->CallObjectMethod(wrapper_instance, get16BitLookupTableMethod);
+    jobjectArray bytesArray =
+        (jobjectArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.get16BitLookupTable);
     if (bytesArray != nullptr)
     {
-        assert(jvm_env->GetArrayLength(bytesArray) == 3); // RGB 3 channels
+        assert(jvm_env()->GetArrayLength(bytesArray) == 3); // RGB 3 channels
 
-        auto b0 = (jshortArray)jvm_env->GetObjectArrayElement(bytesArray, 0);
-        jsize len = jvm_env->GetArrayLength(b0);
-        jvm_env->DeleteLocalRef(b0);
+        auto b0 = (jshortArray)jvm_env()->GetObjectArrayElement(bytesArray, 0);
+        jsize len = jvm_env()->GetArrayLength(b0);
+        jvm_env()->DeleteLocalRef(b0);
         lut->resize(len);
 
         std::vector<short> buffer(len);
         for (jsize i = 0; i < 3; i++)
         {
-            jshortArray b = (jshortArray)jvm_env->GetObjectArrayElement(bytesArray, i);
-            jvm_env->GetShortArrayRegion(b, 0, len, (jshort*)buffer.data());
-            jvm_env->DeleteLocalRef(b);
+            jshortArray b = (jshortArray)jvm_env()->GetObjectArrayElement(bytesArray, i);
+            jvm_env()->GetShortArrayRegion(b, 0, len, (jshort*)buffer.data());
+            jvm_env()->DeleteLocalRef(b);
 
             for (auto j = 0; j < len; j++)
                 (*lut)[j][i] = buffer[j];
         }
     }
-    jvm_env->DeleteLocalRef(bytesArray);
+    jvm_env()->DeleteLocalRef(bytesArray);
     return lut;
 }
 
 int Reader::impl::getBitsPerPixel()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getBitsPerPixel", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getBitsPerPixel);
 }
 
 int Reader::impl::getOptimalTileWidth() const
 {
-    return jvm_env->CallIntMethod(wrapper_instance,
-                                  jvm_wrapper->getMethodID(wrapper_cls, "getOptimalTileWidth", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getOptimalTileWidth);
 }
 
 int Reader::impl::getOptimalTileHeight() const
 {
-    return jvm_env->CallIntMethod(wrapper_instance,
-                                  jvm_wrapper->getMethodID(wrapper_cls, "getOptimalTileHeight", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getOptimalTileHeight);
 }
 
 std::unique_ptr<char[]> Reader::impl::getTile(int no, int x, int y, int w, int h) const
 {
-    jbyteArray byteArray = (jbyteArray)jvm_env->CallObjectMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "openBytes", "(IIIII)[B"), no, x, y, w, h);
+    auto len = static_cast<std::size_t>(w) * h * m_meta.rgb_channel_count * Reader::getBytesPerPixel(m_meta.pixel_type);
+    auto bytes = std::make_unique_for_overwrite<char[]>(len);
+    if (!readTileInto(no, x, y, w, h, std::as_writable_bytes(std::span(bytes.get(), len)))) return nullptr;
 
-    assert(byteArray != nullptr);
+    return bytes;
+}
 
-    jsize len = jvm_env->GetArrayLength(byteArray);
-    auto bytes = std::make_unique<char[]>(sizeof(jbyte) * len);
-    jvm_env->GetByteArrayRegion(byteArray, 0, len, (jbyte*)bytes.get());
-    jvm_env->DeleteLocalRef(byteArray);
+std::unique_ptr<char[]> Reader::impl::getRegion(int no, int x, int y, int w, int h)
+{
+    auto len = static_cast<std::size_t>(w) * h * m_meta.rgb_channel_count * Reader::getBytesPerPixel(m_meta.pixel_type);
+    auto bytes = std::make_unique_for_overwrite<char[]>(len);
+    if (!readRegionInto(no, x, y, w, h, std::as_writable_bytes(std::span(bytes.get(), len)))) return nullptr;
 
     return bytes;
 }
 
+bool Reader::impl::readRegionInto(int no, int x, int y, int w, int h, std::span<std::byte> dst)
+{
+    auto len = static_cast<std::size_t>(w) * h * m_meta.rgb_channel_count * Reader::getBytesPerPixel(m_meta.pixel_type);
+    if (dst.size() < len)
+    {
+        std::cerr << "Error: buffer of " << dst.size() << " bytes is too small for region of " << len << " bytes"
+                  << std::endl;
+        return false;
+    }
+
+    // raw `openBytes` plus a native reorder instead of the per-sample loop in `bfwrapper.openPlane`
+    auto region = dst.first(len);
+    auto raw = region;
+    if (m_meta.rgb_channel_count > 1 && !m_meta.interleaved)
+    {
+        m_scratch.resize(len);
+        raw = m_scratch;
+    }
+    if (!readTileInto(no, x, y, w, h, raw)) return false;
+    reorderPlane(raw, region);
+
+    return true;
+}
+
+bool Reader::impl::readTileInto(int no, int x, int y, int w, int h, std::span<std::byte> dst) const
+{
+    jobject dbb = jvm_env()->NewDirectByteBuffer(dst.data(), static_cast<jlong>(dst.size()));
+    if (dbb == nullptr)
+    {
+        std::cerr << "Error: failed to create direct byte buffer" << std::endl;
+        return false;
+    }
+    auto succeed = jvm_env()->CallBooleanMethod(wrapper_instance, m_methods.openBytesInto, no, x, y, w, h, dbb);
+    jvm_env()->DeleteLocalRef(dbb);
+
+    return succeed;
+}
+
 int Reader::impl::getResolutionCount() const
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getResolutionCount", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getResolutionCount);
 }
 void Reader::impl::setResolution(int level)
 {
-    jvm_env->CallVoidMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "setResolution", "(I)V"), level);
-
-    // update meta
-    m_meta.image_count = getImageCount();
-    m_meta.size_x = getSizeX();
-    m_meta.size_y = getSizeY();
-    m_meta.size_z = getSizeZ();
-    m_meta.size_t = getSizeT();
-    m_meta.size_c = getSizeC();
-    m_meta.physical_size_x = getPhysSizeX();
-    m_meta.physical_size_y = getPhysSizeY();
-    m_meta.physical_size_z = getPhysSizeZ();
-    m_meta.physical_size_t = getPhysSizeT();
-    m_meta.pixel_type = getPixelType();
-    m_meta.rgb_channel_count = getRGBChannelCount();
-    m_meta.channel_colors.resize(m_meta.size_c);
-    for (auto c = 0; c < m_meta.size_c; c++)
-        m_meta.channel_colors[c] = getChannelColor(c);
-    m_meta.plane_size = getPlaneSize();
-    m_meta.bits_per_pixel = getBitsPerPixel();
+    jvm_env()->CallVoidMethod(wrapper_instance, m_methods.setResolution, level);
+    m_meta.resolution = level;
+    readSeriesInfo();
 }
 void Reader::impl::force_gc()
 {
-    jvm_env->CallStaticVoidMethod(system_cls, jvm_env->GetStaticMethodID(system_cls, "gc", "()V"));
+    jvm_env()->CallStaticVoidMethod(system_cls, m_methods.gc);
 }
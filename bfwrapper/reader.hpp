@@ -5,6 +5,9 @@
 #include <memory>
 #include <vector>
 #include <optional>
+#include <span>
+#include <cstddef>
+#include <utility>
 
 class Reader
 {
@@ -25,18 +28,43 @@ public:
     static std::string pixelTypeStr(PixelType pixelType);
     static int getBytesPerPixel(PixelType pixelType);
 
+    // downscaled plane, `size_x` x `size_y` pixels in the layout of `getPlane`
+    struct Thumbnail
+    {
+        int series{};
+        int no{};
+        int size_x{};
+        int size_y{};
+        PixelType pixel_type{};
+        int rgb_channel_count{};
+        std::vector<std::byte> bytes{};
+    };
+    static constexpr int default_thumbnail_size = 256;
+
 public:
     Reader();
     ~Reader();
 
     void setFlattenedResolutions(bool flag);
+    // caches the initialized Bio-Formats reader state of slow to open files under `directory` (Memoizer),
+    // reopening them later skips parsing, empty disables it. Closes the current file, applies to the next `open`.
+    // Defaults to the `BIOIMREAD_MEMO_DIR` environment variable.
+    bool setMemoDirectory(std::string directory);
+    // keeps the thumbnails of `getThumbnail` / `getSeriesThumbnails` on disk under `directory` (see `ThumbnailCache`),
+    // empty disables it. Defaults to the `BIOIMREAD_THUMBNAIL_DIR` environment variable.
+    void setThumbnailDirectory(std::string directory);
     bool open(std::string filePath);
     void close();
     bool reopen();
 
     void setSeries(int no);
 
+    // OME-XML of the whole file, dumped once per opened file
     std::string getMetaXML() const;
+    using MetadataFields = std::vector<std::pair<std::string, std::string>>;
+    // key / value pairs of `series` (name, acquisition date, channels, instrument, objectives, detectors, ...),
+    // read from the metadata store without going through the OME-XML, cached per opened file
+    MetadataFields getSeriesMetadata(int series) const;
 
     int getImageCount() const;
     int getSeriesCount() const;
@@ -64,13 +92,34 @@ public:
 
     int getPlaneIndex(int z, int c, int t) const;
     std::array<int, 3> getZCTCoords(int index) const;
+    // `getRGBChannelCount()` interleaved samples per pixel, little endian
     std::unique_ptr<char[]> getPlane(int no) const;
+    // reads the plane straight into `dst` (at least `getPlaneSize()` bytes), no intermediate allocation
+    bool readPlaneInto(int no, std::span<std::byte> dst) const;
+    // reads planes `nos` back to back into `dst` (at least `nos.size() * getPlaneSize()` bytes)
+    // with one JNI call per 2GB of data
+    bool readPlanes(std::span<int const> nos, std::span<std::byte> dst) const;
+    // plane `no` of the current series area averaged to fit in `max_size` x `max_size` (never upscaled), samples
+    // keep their type; read from the coarsest resolution covering `max_size` (after `setFlattenedResolutions(false)`)
+    // by bands of rows, so any plane size works. Served from / stored into the thumbnail cache.
+    std::optional<Thumbnail> getThumbnail(int no, int max_size = default_thumbnail_size) const;
+    // one thumbnail per series (middle Z section, first channel and timepoint) in a single cache entry, the current
+    // series and resolution are kept (series 0 if none was set); series that can not be read are left out
+    std::vector<Thumbnail> getSeriesThumbnails(int max_size = default_thumbnail_size) const;
     std::unique_ptr<std::vector<std::array<unsigned char, 3>>> get8BitLut() const;
     std::unique_ptr<std::vector<std::array<short, 3>>> get16BitLut() const;
 
     int getOptimalTileWidth() const;
     int getOptimalTileHeight() const;
+    // raw `openBytes` layout: RGB channels one after the other unless the file interleaves them, samples in the
+    // byte order of the file; `getRegion` returns the same pixels in the layout of `getPlane`
     std::unique_ptr<char[]> getTile(int no, int x, int y, int w, int h) const;
+    // `dst` needs at least `w * h * getRGBChannelCount() * getBytesPerPixel()` bytes, same layout as `getTile`
+    bool readTileInto(int no, int x, int y, int w, int h, std::span<std::byte> dst) const;
+    // `w` x `h` pixels at `x`, `y` of plane `no` in the layout of `getPlane`
+    std::unique_ptr<char[]> getRegion(int no, int x, int y, int w, int h) const;
+    // `dst` needs at least `w * h * getRGBChannelCount() * getBytesPerPixel()` bytes
+    bool readRegionInto(int no, int x, int y, int w, int h, std::span<std::byte> dst) const;
 
     // only available after `setFlattenedResolutions`
     int getResolutionCount() const;
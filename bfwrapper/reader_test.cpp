@@ -0,0 +1,76 @@
+#include "reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// checks `Reader::getRegion` against `getPlane` cropped to the same regions, on the first plane of every series:
+// reader_test [image] (a planar, big endian fake image by default)
+
+namespace
+{
+    struct Region
+    {
+        int x, y, w, h;
+    };
+
+    bool matchesPlane(Reader const& reader, char const* plane, Region r)
+    {
+        auto region = reader.getRegion(0, r.x, r.y, r.w, r.h);
+        if (!region) return false;
+        auto pixel_size = static_cast<std::size_t>(reader.getRGBChannelCount()) * reader.getBytesPerPixel();
+        auto plane_row = reader.getSizeX() * pixel_size;
+        auto region_row = r.w * pixel_size;
+        for (auto row = 0; row < r.h; row++)
+            if (std::memcmp(plane + (r.y + row) * plane_row + r.x * pixel_size, region.get() + row * region_row,
+                            region_row) != 0)
+                return false;
+        return true;
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string path = "region&sizeX=301&sizeY=203&sizeC=3&rgb=3&pixelType=uint16&little=false&series=2.fake";
+    if (argc > 1) path = argv[1];
+
+    Reader reader;
+    if (!reader.open(path))
+    {
+        std::cerr << "Error: failed to open " << path << std::endl;
+        return 1;
+    }
+
+    auto failures = 0;
+    for (auto s = 0; s < reader.getSeriesCount(); s++)
+    {
+        reader.setSeries(s);
+        auto w = reader.getSizeX();
+        auto h = reader.getSizeY();
+        auto plane = reader.getPlane(0);
+        if (!plane)
+        {
+            std::cerr << "Error: failed to read series " << s << std::endl;
+            return 1;
+        }
+        // whole plane, corners, odd offsets and sizes, single rows / columns on the edges
+        std::vector<Region> regions{{0, 0, w, h},
+                                    {0, 0, (w + 1) / 2, (h + 1) / 2},
+                                    {w / 2, h / 2, w - w / 2, h - h / 2},
+                                    {w / 3, h / 5, std::max(1, w / 2 - 1), std::max(1, h / 3 + 1)},
+                                    {w - 1, 0, 1, h},
+                                    {0, h - 1, w, 1}};
+        for (auto r : regions)
+        {
+            auto match = matchesPlane(reader, plane.get(), r);
+            std::cout << "series " << s << " region " << r.x << "," << r.y << " " << r.w << "x" << r.h << ": "
+                      << (match ? "ok" : "MISMATCH") << std::endl;
+            failures += !match;
+        }
+    }
+    std::cout << (failures ? std::to_string(failures) + " regions differ from the plane" : "all regions match")
+              << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+#include "readerpool.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+ReaderPool::ReaderPool(std::string filePath, int series, int threads)
+{
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    auto start = [&] {
+        std::promise<int> opened;
+        auto plane_size = opened.get_future();
+        m_workers.emplace_back(&ReaderPool::run, this, filePath, series, std::move(opened));
+        return plane_size;
+    };
+
+    // the first worker may create the JVM, a missing jar or a broken file is reported once instead of per worker
+    m_plane_size = start().get();
+    if (m_plane_size < 0)
+    {
+        m_valid = false;
+        return;
+    }
+    std::vector<std::future<int>> opened;
+    for (auto i = 1; i < threads; i++)
+        opened.push_back(start());
+    for (auto& f : opened)
+        if (f.get() < 0) m_valid = false;
+}
+
+ReaderPool::~ReaderPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    // readers are destroyed and threads detached from the JVM inside `run`
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+bool ReaderPool::isValid() const
+{
+    return m_valid;
+}
+
+int ReaderPool::size() const
+{
+    return static_cast<int>(m_workers.size());
+}
+
+int ReaderPool::getPlaneSize() const
+{
+    return m_plane_size;
+}
+
+std::future<bool> ReaderPool::readPlaneInto(int no, std::span<std::byte> dst)
+{
+    return submit([no, dst](Reader& reader) { return reader.readPlaneInto(no, dst); });
+}
+
+bool ReaderPool::readPlanesInto(std::span<int const> nos, std::span<std::byte> dst)
+{
+    auto plane_size = static_cast<std::size_t>(m_plane_size);
+    if (dst.size() < nos.size() * plane_size)
+    {
+        std::cerr << "Error: buffer of " << dst.size() << " bytes is too small for " << nos.size() << " planes of "
+                  << plane_size << " bytes" << std::endl;
+        return false;
+    }
+
+    // contiguous runs go through `Reader::readPlanes` (one JNI call each),
+    // two runs per worker leave some room for uneven plane decode times
+    auto runs = std::max<std::size_t>(1, std::min(nos.size(), m_workers.size() * 2));
+    auto per_run = (nos.size() + runs - 1) / runs;
+    std::vector<std::future<bool>> planes;
+    for (std::size_t i = 0; i < nos.size(); i += per_run)
+    {
+        auto n = std::min(per_run, nos.size() - i);
+        auto ids = nos.subspan(i, n);
+        auto out = dst.subspan(i * plane_size, n * plane_size);
+        planes.push_back(submit([ids, out](Reader& reader) { return reader.readPlanes(ids, out); }));
+    }
+
+    bool succeed = true;
+    for (auto& plane : planes)
+        succeed &= plane.get();
+    return succeed;
+}
+
+std::future<bool> ReaderPool::submit(std::function<bool(Reader&)> f)
+{
+    if (m_plane_size < 0)
+    {
+        // no worker is running
+        std::promise<bool> failed;
+        failed.set_value(false);
+        return failed.get_future();
+    }
+
+    auto task = std::make_shared<std::packaged_task<bool(Reader&)>>(std::move(f));
+    auto res = task->get_future();
+    {
+        std::lock_guard lock(m_mutex);
+        m_tasks.emplace([task](Reader& reader) { (*task)(reader); });
+    }
+    m_cv.notify_one();
+    return res;
+}
+
+void ReaderPool::run(std::string filePath, int series, std::promise<int> opened)
+{
+    Reader reader;
+    if (!reader.open(filePath))
+    {
+        std::cerr << "Error: ReaderPool failed to open " << filePath << std::endl;
+        opened.set_value(-1);
+        return;
+    }
+    reader.setSeries(series);
+    opened.set_value(reader.getPlaneSize());
+
+    while (true)
+    {
+        std::function<void(Reader&)> task;
+        {
+            std::unique_lock lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+            if (m_stop && m_tasks.empty()) return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        task(reader);
+    }
+}
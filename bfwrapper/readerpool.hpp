@@ -0,0 +1,47 @@
+#pragma once
+
+#include "reader.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+// worker threads each owning a `Reader` (own `bfwrapper` instance, own attached `JNIEnv`) on the same file,
+// so planes of a Z-stack / time series decode in parallel
+class ReaderPool
+{
+public:
+    // `threads <= 0` uses `std::thread::hardware_concurrency()`
+    explicit ReaderPool(std::string filePath, int series = 0, int threads = 0);
+    ~ReaderPool();
+
+    ReaderPool(ReaderPool const&) = delete;
+    ReaderPool& operator=(ReaderPool const&) = delete;
+
+    // false if any worker failed to open the file
+    bool isValid() const;
+    int size() const;
+    int getPlaneSize() const;
+
+    // `dst` must stay alive until the future is ready
+    std::future<bool> readPlaneInto(int no, std::span<std::byte> dst);
+    // plane `nos[i]` goes to `dst[i * getPlaneSize()]`, split into `Reader::readPlanes` batches over the workers,
+    // blocks until all planes are read
+    bool readPlanesInto(std::span<int const> nos, std::span<std::byte> dst);
+
+private:
+    std::future<bool> submit(std::function<bool(Reader&)> f);
+    void run(std::string filePath, int series, std::promise<int> opened);
+
+private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void(Reader&)>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+    bool m_valid = true;
+    int m_plane_size = 0;
+};
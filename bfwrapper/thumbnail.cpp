@@ -0,0 +1,261 @@
+#include "thumbnail.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+
+namespace
+{
+    // calls `f(std::type_identity<T>{})` with the sample type of `type`, BIT samples are bytes
+    template <typename F>
+    decltype(auto) withSampleType(Reader::PixelType type, F&& f)
+    {
+        switch (type)
+        {
+        case Reader::PixelType::INT8:
+            return f(std::type_identity<std::int8_t>{});
+        case Reader::PixelType::INT16:
+            return f(std::type_identity<std::int16_t>{});
+        case Reader::PixelType::UINT16:
+            return f(std::type_identity<std::uint16_t>{});
+        case Reader::PixelType::INT32:
+            return f(std::type_identity<std::int32_t>{});
+        case Reader::PixelType::UINT32:
+            return f(std::type_identity<std::uint32_t>{});
+        case Reader::PixelType::FLOAT:
+            return f(std::type_identity<float>{});
+        case Reader::PixelType::DOUBLE:
+            return f(std::type_identity<double>{});
+        default:
+            return f(std::type_identity<std::uint8_t>{});
+        }
+    }
+
+    // bumped whenever the entry layout changes, older entries are then read again from the images
+    constexpr char entry_magic[8] = {'B', 'I', 'O', 'T', 'H', 'U', 'M', '1'};
+    // more than any entry holds, guard against allocating for corrupted counts / sizes
+    constexpr std::uint32_t max_entry_thumbnails = 1 << 16;
+    constexpr std::uint64_t max_entry_bytes = 1ULL << 30;
+
+    template <typename T>
+    void writeValue(std::ostream& out, T value)
+    {
+        out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    T readValue(std::istream& in)
+    {
+        T value{};
+        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return value;
+    }
+} // namespace
+
+AreaDownscaler::AreaDownscaler(Reader::PixelType type, int channels, int width, int height, int out_width,
+                               int out_height):
+    m_type(type),
+    m_channels(channels),
+    m_width(width),
+    m_height(height),
+    m_out_width(out_width),
+    m_out_height(out_height),
+    m_columns(width),
+    m_sums(static_cast<std::size_t>(out_width) * out_height * channels),
+    m_counts(static_cast<std::size_t>(out_width) * out_height)
+{
+    for (auto x = 0; x < width; x++)
+        m_columns[x] = static_cast<int>(static_cast<long long>(x) * out_width / width);
+}
+
+void AreaDownscaler::addRows(int y, int rows, std::byte const* data)
+{
+    withSampleType(m_type, [&]<typename T>(std::type_identity<T>) {
+        accumulate(y, rows, reinterpret_cast<T const*>(data));
+    });
+}
+
+std::vector<std::byte> AreaDownscaler::result() const
+{
+    return withSampleType(m_type, [&]<typename T>(std::type_identity<T>) { return average<T>(); });
+}
+
+template <typename T>
+void AreaDownscaler::accumulate(int y, int rows, T const* data)
+{
+    for (auto row = 0; row < rows; row++)
+    {
+        auto out_y = static_cast<std::size_t>(static_cast<long long>(y + row) * m_out_height / m_height);
+        auto* counts = m_counts.data() + out_y * m_out_width;
+        auto* sums = m_sums.data() + out_y * m_out_width * m_channels;
+        auto* samples = data + static_cast<std::size_t>(row) * m_width * m_channels;
+        for (auto x = 0; x < m_width; x++)
+        {
+            auto out_x = m_columns[x];
+            counts[out_x]++;
+            for (auto c = 0; c < m_channels; c++)
+                sums[out_x * m_channels + c] += static_cast<double>(samples[x * m_channels + c]);
+        }
+    }
+}
+
+template <typename T>
+std::vector<std::byte> AreaDownscaler::average() const
+{
+    std::vector<std::byte> bytes(m_sums.size() * sizeof(T));
+    auto* out = reinterpret_cast<T*>(bytes.data());
+    for (std::size_t i = 0; i < m_sums.size(); i++)
+    {
+        auto count = m_counts[i / m_channels];
+        auto value = count ? m_sums[i] / count : 0.;
+        if constexpr (std::is_integral_v<T>)
+            out[i] = static_cast<T>(std::clamp(std::round(value), static_cast<double>(std::numeric_limits<T>::min()),
+                                               static_cast<double>(std::numeric_limits<T>::max())));
+        else
+            out[i] = static_cast<T>(value);
+    }
+    return bytes;
+}
+
+ThumbnailCache::ThumbnailCache(std::filesystem::path directory): m_directory(std::move(directory)) {}
+
+std::optional<Reader::Thumbnail> ThumbnailCache::get(std::string const& path, int series, int no, int max_size) const
+{
+    auto thumbnails = read(key(path, "series " + std::to_string(series) + " plane " + std::to_string(no), max_size));
+    if (!thumbnails || thumbnails->size() != 1) return std::nullopt;
+    return std::move(thumbnails->front());
+}
+
+bool ThumbnailCache::put(std::string const& path, Reader::Thumbnail const& thumbnail, int max_size) const
+{
+    auto what = "series " + std::to_string(thumbnail.series) + " plane " + std::to_string(thumbnail.no);
+    return write(key(path, what, max_size), std::span(&thumbnail, 1));
+}
+
+std::optional<std::vector<Reader::Thumbnail>> ThumbnailCache::getSeries(std::string const& path, int max_size) const
+{
+    return read(key(path, "all series", max_size));
+}
+
+bool ThumbnailCache::putSeries(std::string const& path, std::vector<Reader::Thumbnail> const& thumbnails,
+                               int max_size) const
+{
+    return write(key(path, "all series", max_size), thumbnails);
+}
+
+std::string ThumbnailCache::key(std::string const& path, std::string const& what, int max_size)
+{
+    std::error_code ec;
+    auto absolute = std::filesystem::absolute(path, ec);
+    if (ec) return {};
+    auto mtime = std::filesystem::last_write_time(absolute, ec);
+    if (ec) return {};
+
+    std::ostringstream key;
+    key << absolute.string() << '\n'
+        << mtime.time_since_epoch().count() << '\n'
+        << what << '\n'
+        << max_size;
+    return key.str();
+}
+
+std::filesystem::path ThumbnailCache::entry(std::string const& key) const
+{
+    // only needs to be stable on this machine, the key stored in the entry settles collisions
+    std::ostringstream name;
+    name << std::hex << std::hash<std::string>{}(key) << ".thumb";
+    return m_directory / name.str();
+}
+
+std::optional<std::vector<Reader::Thumbnail>> ThumbnailCache::read(std::string const& key) const
+{
+    if (key.empty() || m_directory.empty()) return std::nullopt;
+    std::ifstream in(entry(key), std::ios::binary);
+    if (!in) return std::nullopt;
+
+    char magic[sizeof(entry_magic)]{};
+    in.read(magic, sizeof(magic));
+    if (!in || std::memcmp(magic, entry_magic, sizeof(magic)) != 0) return std::nullopt;
+    auto key_size = readValue<std::uint32_t>(in);
+    if (!in || key_size != key.size()) return std::nullopt;
+    std::string stored_key(key_size, '\0');
+    in.read(stored_key.data(), static_cast<std::streamsize>(key_size));
+    if (!in || stored_key != key) return std::nullopt;
+
+    auto count = readValue<std::uint32_t>(in);
+    if (!in || count > max_entry_thumbnails) return std::nullopt;
+    std::vector<Reader::Thumbnail> thumbnails(count);
+    for (auto& thumbnail : thumbnails)
+    {
+        thumbnail.series = readValue<std::int32_t>(in);
+        thumbnail.no = readValue<std::int32_t>(in);
+        thumbnail.size_x = readValue<std::int32_t>(in);
+        thumbnail.size_y = readValue<std::int32_t>(in);
+        auto type = readValue<std::int32_t>(in);
+        thumbnail.pixel_type = static_cast<Reader::PixelType>(type);
+        thumbnail.rgb_channel_count = readValue<std::int32_t>(in);
+        auto size = readValue<std::uint64_t>(in);
+        auto expected = static_cast<std::uint64_t>(std::max(thumbnail.size_x, 0)) * std::max(thumbnail.size_y, 0) *
+                        std::max(thumbnail.rgb_channel_count, 0) * Reader::getBytesPerPixel(thumbnail.pixel_type);
+        // truncated or foreign entry
+        if (!in || type < 0 || type > static_cast<int>(Reader::PixelType::BIT) || size != expected ||
+            size > max_entry_bytes)
+            return std::nullopt;
+        thumbnail.bytes.resize(size);
+        in.read(reinterpret_cast<char*>(thumbnail.bytes.data()), static_cast<std::streamsize>(size));
+        if (!in) return std::nullopt;
+    }
+    return thumbnails;
+}
+
+bool ThumbnailCache::write(std::string const& key, std::span<Reader::Thumbnail const> thumbnails) const
+{
+    if (key.empty() || m_directory.empty()) return false;
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+
+    // written aside and renamed, readers (other processes too) never see a partial entry
+    auto path = entry(key);
+    auto temp = path;
+    temp += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(entry_magic, sizeof(entry_magic));
+        writeValue(out, static_cast<std::uint32_t>(key.size()));
+        out.write(key.data(), static_cast<std::streamsize>(key.size()));
+        writeValue(out, static_cast<std::uint32_t>(thumbnails.size()));
+        for (auto const& thumbnail : thumbnails)
+        {
+            writeValue<std::int32_t>(out, thumbnail.series);
+            writeValue<std::int32_t>(out, thumbnail.no);
+            writeValue<std::int32_t>(out, thumbnail.size_x);
+            writeValue<std::int32_t>(out, thumbnail.size_y);
+            writeValue<std::int32_t>(out, static_cast<std::int32_t>(thumbnail.pixel_type));
+            writeValue<std::int32_t>(out, thumbnail.rgb_channel_count);
+            writeValue<std::uint64_t>(out, thumbnail.bytes.size());
+            out.write(reinterpret_cast<char const*>(thumbnail.bytes.data()),
+                      static_cast<std::streamsize>(thumbnail.bytes.size()));
+        }
+        if (!out)
+        {
+            std::cerr << "Error: failed to write thumbnail cache entry " << temp.string() << std::endl;
+            out.close();
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
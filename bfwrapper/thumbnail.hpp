@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "reader.hpp"
+
+// area averaging of `width` x `height` images of `channels` interleaved samples (`getPlane` layout) down to
+// `out_width` x `out_height`, fed in bands of rows so that large planes never have to be held at once
+class AreaDownscaler
+{
+public:
+    AreaDownscaler(Reader::PixelType type, int channels, int width, int height, int out_width, int out_height);
+
+    // `rows` full rows starting at row `y`
+    void addRows(int y, int rows, std::byte const* data);
+    // `out_width * out_height * channels` samples of the input type, rounded for integer types
+    std::vector<std::byte> result() const;
+
+private:
+    template <typename T>
+    void accumulate(int y, int rows, T const* data);
+    template <typename T>
+    std::vector<std::byte> average() const;
+
+private:
+    Reader::PixelType m_type;
+    int m_channels;
+    int m_width;
+    int m_height;
+    int m_out_width;
+    int m_out_height;
+    // output column of every input column
+    std::vector<int> m_columns;
+    // per output sample / pixel
+    std::vector<double> m_sums;
+    std::vector<std::uint32_t> m_counts;
+};
+
+// on-disk `Reader::Thumbnail`s, one file per entry under `directory` named after a hash of its key: the image path,
+// its modification time and the request. Rewritten images are read again, and a directory browsed before is shown
+// without opening its images (nor starting the JVM). Entries are written in the native byte order.
+class ThumbnailCache
+{
+public:
+    explicit ThumbnailCache(std::filesystem::path directory);
+
+    // plane `no` of `series` of `path` downscaled to `max_size`, see `Reader::getThumbnail`
+    std::optional<Reader::Thumbnail> get(std::string const& path, int series, int no, int max_size) const;
+    bool put(std::string const& path, Reader::Thumbnail const& thumbnail, int max_size) const;
+    // every series of `path`, see `Reader::getSeriesThumbnails`
+    std::optional<std::vector<Reader::Thumbnail>> getSeries(std::string const& path, int max_size) const;
+    bool putSeries(std::string const& path, std::vector<Reader::Thumbnail> const& thumbnails, int max_size) const;
+
+private:
+    // empty if `path` can not be stat'ed
+    static std::string key(std::string const& path, std::string const& what, int max_size);
+    std::filesystem::path entry(std::string const& key) const;
+    std::optional<std::vector<Reader::Thumbnail>> read(std::string const& key) const;
+    bool write(std::string const& key, std::span<Reader::Thumbnail const> thumbnails) const;
+
+private:
+    std::filesystem::path m_directory;
+};
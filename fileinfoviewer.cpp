@@ -7,7 +7,6 @@
 #include <QFileInfo>
 #include <QDebug>
 #include <QTextBrowser>
-#include <QDomDocument>
 
 KVItem::KVItem(QWidget* parent): QWidget(parent)
 {
@@ -92,69 +91,12 @@ QString FileInfoViewer::getFileName() const
     return m_fi.fileName();
 }
 
-void FileInfoViewer::setExtra(QString const& xml_str)
+void FileInfoViewer::setExtra(Reader::MetadataFields const& metadata)
 {
-    m_xml_str = xml_str;
-    m_series_no = -1;
-    m_instrument_strs.clear();
-
-    // https://ome-model.readthedocs.io/en/stable/developers/model-overview.html
-    QDomDocument doc("meta");
-    doc.setContent(m_xml_str);
-    QDomElement topElement = doc.documentElement();
-    QDomNode domNode = topElement.firstChild();
-    while (!domNode.isNull())
-    {
-        QDomElement domElement = domNode.toElement();
-        if (!domElement.isNull())
-        {
-            // Experimenter / Instrument / Image / StructuredAnnotations / ...
-            // qDebug() << domElement.tagName();
-            if (domElement.tagName() == "Instrument")
-            {
-                QString intrument_str = parse_node(domElement.firstChild());
-                m_instrument_strs.append(intrument_str);
-            }
-        }
-        domNode = domNode.nextSibling();
-    }
-
-    setExtra(0);
-}
-
-void FileInfoViewer::setExtra(int series_no)
-{
-    if (m_series_no == series_no) return;
-    m_series_no = series_no;
-
-    m_extra->setText("");
-    if (m_xml_str.isEmpty()) return;
-
-    // https://ome-model.readthedocs.io/en/stable/developers/model-overview.html
-    QDomDocument doc("meta");
-    doc.setContent(m_xml_str);
-    QDomElement topElement = doc.documentElement();
-    QDomNode domNode = topElement.firstChild();
-    while (!domNode.isNull())
-    {
-        QDomElement domElement = domNode.toElement();
-        if (!domElement.isNull())
-        {
-            if (domElement.tagName() == "Image" && domElement.attribute("ID") == QString("Image:%1").arg(m_series_no))
-            {
-                // <InstrumentRef ID="Instrument:0"/>
-                if (auto id_sl = domElement.namedItem("InstrumentRef").toElement().attribute("ID").split(":");
-                    id_sl.size() > 1)
-                {
-                    bool ok = false;
-                    auto id = id_sl[1].toInt(&ok, 10);
-                    if (ok && (m_instrument_strs.size() > id)) m_extra->setText(m_instrument_strs[id]);
-                }
-                break;
-            }
-        }
-        domNode = domNode.nextSibling();
-    }
+    QString str{};
+    for (auto const& [key, value] : metadata)
+        str.append(QString("%1 = %2\n").arg(QString::fromStdString(key), QString::fromStdString(value)));
+    m_extra->setPlainText(str);
 }
 
 void FileInfoViewer::setImageInfo(QSize sz, int depth)
@@ -162,35 +104,3 @@ void FileInfoViewer::setImageInfo(QSize sz, int depth)
     m_img_sz_item->setKV("Image Size:", QString("%1 x %2").arg(sz.width()).arg(sz.height()));
     m_img_bd_item->setKV("Image BitDepth:", QString::number(depth));
 }
-
-QString FileInfoViewer::parse_node(QDomNode node, int indent)
-{
-    QString str{};
-    while (!node.isNull())
-    {
-        QDomElement element = node.toElement();
-        if (!element.isNull() && element.hasAttributes())
-        {
-            str.append(QString(indent, QChar::Space) + element.tagName() + ":\n");
-            QDomNamedNodeMap map = element.attributes();
-            for (auto i = 0; i < map.length(); i++)
-                if (!(map.item(i).isNull()))
-                {
-                    if (QDomAttr attr = map.item(i).toAttr(); !attr.isNull())
-                        str.append(QString("%1%2 = %3\n")
-                                       .arg(QString(indent + 2, QChar::Space))
-                                       .arg(attr.name())
-                                       .arg(attr.value()));
-                }
-        }
-        if (element.hasChildNodes())
-        {
-            auto childNodes = element.childNodes();
-            for (auto i = 0; i < childNodes.length(); i++)
-                str += parse_node(childNodes.at(i), indent + 4);
-        }
-
-        node = node.nextSibling();
-    }
-    return str;
-}
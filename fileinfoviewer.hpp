@@ -4,7 +4,8 @@
 #include <QLabel>
 #include <QDateTime>
 #include <QFileInfo>
-#include <QDomNode>
+
+#include "bfwrapper/reader.hpp"
 
 class QTextBrowser;
 
@@ -32,14 +33,11 @@ public:
     void setPath(QString const& path);
     QString getFileName() const;
 
-    void setExtra(QString const& xml_str);
-    void setExtra(int series_no);
+    // key / value pairs of the shown series, see `Reader::getSeriesMetadata`
+    void setExtra(Reader::MetadataFields const& metadata);
 
     void setImageInfo(QSize sz, int depth);
 
-private:
-    QString parse_node(QDomNode node, int indent = 0);
-
 private:
     QFileInfo m_fi{};
     KVItem* m_path_item = nullptr;
@@ -49,8 +47,4 @@ private:
     KVItem* m_img_sz_item = nullptr;
     KVItem* m_img_bd_item = nullptr;
     QTextBrowser* m_extra = nullptr;
-
-    QString m_xml_str{};
-    QList<QString> m_instrument_strs{};
-    int m_series_no = -1;
 };
\ No newline at end of file
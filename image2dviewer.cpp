@@ -10,6 +10,11 @@
 #include <QClipBoard>
 #include <QMenu>
 #include <QFileDialog>
+#include <QCache>
+#include <QPixmap>
+#include <QSet>
+
+#include <algorithm>
 
 class Image2DViewer::ImageWidget: public QWidget
 {
@@ -40,6 +45,37 @@ public:
     }
     QSize imageSize() const { return m_image.size(); }
 
+    bool tiled() const { return !m_levels.isEmpty(); }
+    QList<TileLevel> const& levels() const { return m_levels; }
+    void setLevels(QList<TileLevel> levels)
+    {
+        m_levels = std::move(levels);
+        clearTiles();
+    }
+    void clearTiles()
+    {
+        m_tiles.clear();
+        m_pending.clear();
+        m_failed.clear();
+        update();
+    }
+    void setTile(int level, QPoint tile, QImage const& image)
+    {
+        auto key = tileKey(level, tile);
+        m_pending.remove(key);
+        if (level < 0 || level >= m_levels.size()) return;
+        if (image.isNull())
+        {
+            m_failed.insert(key);
+            return;
+        }
+        m_tiles.insert(key, new QPixmap(QPixmap::fromImage(image)),
+                       std::max<qsizetype>(1, image.width() * image.height() * 4 / 1024));
+        update(tileRect(level, tile, image.size()).toAlignedRect());
+    }
+    // called from `paintEvent` with the missing visible tiles
+    std::function<void(int level, QList<QPoint> tiles)> request_tiles;
+
 protected:
     QSize sizeHint() const override { return m_image.size(); }
     void paintEvent(QPaintEvent* ev) override
@@ -61,6 +97,7 @@ protected:
             sourceRect &= QRectF(ev->rect().x() / scale, ev->rect().y() / scale, ev->rect().width() / scale,
                                  ev->rect().height() / scale);
             painter.drawImage(targetRect, m_image, sourceRect);
+            if (tiled()) paintTiles(painter, targetRect.toAlignedRect());
             return;
         }
         painter.scale(scale, scale);
@@ -74,9 +111,77 @@ protected:
         painter.drawImage(upperLeft, m_image);
     }
 
+private:
+    static quint64 tileKey(int level, QPoint tile)
+    {
+        return (quint64(level) << 48) | (quint64(tile.y()) << 24) | quint64(tile.x());
+    }
+
+    // widget pixels per pixel of `level`, same fitting as `paintEvent`
+    float levelScale(int level) const
+    {
+        auto size = m_levels[level].size;
+        return qMax(float(width()) / size.width(), float(height()) / size.height());
+    }
+
+    QRectF tileRect(int level, QPoint tile, QSize size) const
+    {
+        auto scale = levelScale(level);
+        auto tile_size = m_levels[level].tile;
+        return QRectF(tile.x() * tile_size.width() * scale, tile.y() * tile_size.height() * scale,
+                      size.width() * scale, size.height() * scale);
+    }
+
+    // the tiles of the coarsest level still at least as detailed as the screen over the overview
+    void paintTiles(QPainter& painter, QRect visible)
+    {
+        auto level = 0;
+        for (auto i = 1; i < m_levels.size(); i++)
+            if (levelScale(i) <= 1) level = i;
+        // the overview is the last level
+        if (level == m_levels.size() - 1) return;
+
+        auto scale = levelScale(level);
+        auto [size, tile_size] = m_levels[level];
+        auto cols = (size.width() + tile_size.width() - 1) / tile_size.width();
+        auto rows = (size.height() + tile_size.height() - 1) / tile_size.height();
+        auto first_col = std::clamp(int(visible.left() / scale / tile_size.width()), 0, cols - 1);
+        auto last_col = std::clamp(int((visible.right() + 1) / scale / tile_size.width()), 0, cols - 1);
+        auto first_row = std::clamp(int(visible.top() / scale / tile_size.height()), 0, rows - 1);
+        auto last_row = std::clamp(int((visible.bottom() + 1) / scale / tile_size.height()), 0, rows - 1);
+
+        QList<QPoint> missing;
+        auto requested = true;
+        for (auto row = first_row; row <= last_row; row++)
+            for (auto col = first_col; col <= last_col; col++)
+            {
+                QPoint tile(col, row);
+                auto key = tileKey(level, tile);
+                if (auto* pixmap = m_tiles.object(key))
+                    painter.drawPixmap(tileRect(level, tile, pixmap->size()), *pixmap, pixmap->rect());
+                else if (!m_failed.contains(key))
+                {
+                    missing.append(tile);
+                    requested &= m_pending.contains(key);
+                }
+            }
+        // tiles that scrolled out of view are dropped with the previous request
+        if (missing.isEmpty() || requested || !request_tiles) return;
+        m_pending.clear();
+        for (auto tile : missing)
+            m_pending.insert(tileKey(level, tile));
+        request_tiles(level, missing);
+    }
+
 private:
     QImage m_image;
     qreal m_rotation = 0;
+
+    QList<TileLevel> m_levels;
+    // cost in KB
+    QCache<quint64, QPixmap> m_tiles{256 * 1024};
+    QSet<quint64> m_pending;
+    QSet<quint64> m_failed;
 };
 
 class MyScrollArea: public QScrollArea
@@ -94,6 +199,7 @@ Image2DViewer::Image2DViewer(QWidget* parent): QWidget(parent)
     m_cursor_is_hidden = false;
     m_move_image_locked = false;
     m_image_widget = new ImageWidget;
+    m_image_widget->request_tiles = [this](int level, QList<QPoint> tiles) { emit tilesNeeded(level, tiles); };
 
     m_scroll_area = new MyScrollArea;
     m_scroll_area->setContentsMargins(0, 0, 0, 0);
@@ -118,6 +224,7 @@ Image2DViewer::~Image2DViewer() = default;
 
 void Image2DViewer::loadImage(QImage image)
 {
+    m_image_widget->setLevels({});
     m_temp_disable_resize = false;
     m_image_zoom_factor = 1.f;
     m_orig_image = image;
@@ -126,6 +233,30 @@ void Image2DViewer::loadImage(QImage image)
     reload();
 }
 
+void Image2DViewer::loadTiled(QImage overview, QList<TileLevel> levels)
+{
+    m_temp_disable_resize = false;
+    m_image_zoom_factor = 1.f;
+    m_orig_image = overview;
+    m_image_widget->setLevels(std::move(levels));
+
+    QApplication::processEvents();
+    reload();
+}
+
+void Image2DViewer::resetTiles(QImage overview)
+{
+    m_orig_image = overview;
+    m_viewer_image = m_orig_image;
+    m_image_widget->setImage(m_viewer_image);
+    m_image_widget->clearTiles();
+}
+
+void Image2DViewer::setTile(int level, QPoint tile, QImage image)
+{
+    m_image_widget->setTile(level, tile, image);
+}
+
 void Image2DViewer::resizeImage()
 {
     static bool busy = false;
@@ -377,7 +508,17 @@ void Image2DViewer::wheelEvent(QWheelEvent* event)
     if (!m_temp_disable_resize)
     {
         int angleDelta = event->angleDelta().ry();
-        if (angleDelta > 0)
+        if (m_image_widget->tiled())
+        {
+            // geometric steps to get from the whole slide to its full resolution, up to 4 screen pixels per pixel
+            auto full = m_image_widget->levels().front().size;
+            auto max_zoom = 4.f * qMax(float(full.width()) / width(), float(full.height()) / height());
+            if (angleDelta > 0)
+                m_image_zoom_factor = qMin(m_image_zoom_factor * 1.25f, qMax(max_zoom, 1.f));
+            else if (angleDelta < 0)
+                m_image_zoom_factor = qMax(m_image_zoom_factor / 1.25f, 0.1f);
+        }
+        else if (angleDelta > 0)
             m_image_zoom_factor += 0.1f;
         else if (angleDelta < 0)
             m_image_zoom_factor -= 0.1f;
@@ -2,8 +2,19 @@
 
 #include <QWidget>
 
+#include <functional>
+
 class QScrollArea;
 
+// one resolution level of a tiled image, level 0 is the full resolution
+struct TileLevel
+{
+    QSize size;
+    QSize tile;
+
+    bool operator==(TileLevel const&) const = default;
+};
+
 class Image2DViewer: public QWidget
 {
     Q_OBJECT
@@ -12,6 +23,14 @@ public:
     ~Image2DViewer();
 
     void loadImage(QImage image);
+    // multi-resolution image browsed at any zoom with bounded memory: `overview` is stretched over the full
+    // resolution and covered by the visible tiles of the level matching the zoom, cached as pixmaps once they
+    // come in through `setTile` (requested with `tilesNeeded`); resets the zoom like `loadImage`
+    void loadTiled(QImage overview, QList<TileLevel> levels);
+    // new overview and tiles for the same levels (e.g. another plane or intensity window), keeps the zoom
+    void resetTiles(QImage overview);
+    // null `image` if the tile could not be read, it is not requested again until the next reset
+    void setTile(int level, QPoint tile, QImage image);
     void resizeImage();
     void setCursorHiding(bool hide);
     void refresh();
@@ -23,6 +42,8 @@ public:
 
 signals:
     void imageSaved(QString);
+    // missing visible tiles of `level`, supersedes the previous request
+    void tilesNeeded(int level, QList<QPoint> tiles);
 
 public slots:
     void monitorCursorState();
@@ -1,6 +1,7 @@
 #include "image5dviewer.hpp"
 #include "ui_image5dviewer.h"
 
+#include <QDebug>
 #include <QFileDialog>
 #include <QImageReader>
 #include <QMovie>
@@ -12,20 +13,15 @@ Image5DViewer::Image5DViewer(QWidget* parent): QWidget(parent), ui(new Ui::Image
 {
     ui->setupUi(this);
 
-    connect(ui->slider_s, &QSlider::valueChanged, [this](int) {
-        update(true);
-        seriesChanged(ui->slider_s->value());
-    });
+    connect(ui->slider_s, &QSlider::valueChanged, [this](int) { update(true); });
     connect(ui->slider_z, &QSlider::valueChanged, [this](int) { update(true); });
     connect(ui->slider_c, &QSlider::valueChanged, [this](int) { update(true); });
     connect(ui->slider_t, &QSlider::valueChanged, [this](int) { update(true); });
 
     connect(ui->btn, &QPushButton::pressed, [this] { openFile(); });
+    connect(ui->clip_sbox, &QDoubleSpinBox::valueChanged, [this](double) { render(false); });
 
-    connect(ui->s_sbox, &QSpinBox::valueChanged, [this](int) {
-        update(false);
-        seriesChanged(ui->slider_s->value());
-    });
+    connect(ui->s_sbox, &QSpinBox::valueChanged, [this](int) { update(false); });
     connect(ui->z_sbox, &QSpinBox::valueChanged, [this](int) { update(false); });
     connect(ui->c_sbox, &QSpinBox::valueChanged, [this](int) { update(false); });
     connect(ui->t_sbox, &QSpinBox::valueChanged, [this](int) { update(false); });
@@ -33,6 +29,8 @@ Image5DViewer::Image5DViewer(QWidget* parent): QWidget(parent), ui(new Ui::Image
 
 Image5DViewer::~Image5DViewer()
 {
+    // waits for the plane being read
+    delete loader;
     delete ui;
     delete reader;
 }
@@ -41,12 +39,25 @@ void Image5DViewer::openFile()
 {
     QString filePath = QFileDialog::getOpenFileName(this, tr("Open Image"), "", tr("*;;*.lsm;; *.czi;; *.ome.tiff"));
     if (filePath.isEmpty()) return;
+    open_timer.start();
+    first_pixels = false;
 
-    if (reader) reader->close();
-
-    // FIXME: have to always use new reader to obtain current file's XML...
-    delete reader;
-    reader = new Reader;
+    // the OME-XML and series metadata are reset with the file, the reader (and its JVM objects) is reused
+    if (reader)
+    {
+        // nothing may use the reader while it switches files
+        loader->reset();
+        reader->close();
+    }
+    else
+    {
+        reader = new Reader;
+        loader = new PlaneLoader(reader, this);
+        connect(loader, &PlaneLoader::loaded, this, &Image5DViewer::onPlaneLoaded);
+        connect(loader, &PlaneLoader::tileLoaded, ui->viewer, &Image2DViewer::setTile);
+        connect(ui->viewer, &Image2DViewer::tilesNeeded, loader, &PlaneLoader::requestTiles);
+    }
+    curr_plane = {};
 
     // handle plain image with qt
     // TODO: mime type seems more reliable than file extension
@@ -78,7 +89,7 @@ void Image5DViewer::openFile()
                 ui->viewer->loadImage(curr_img);
                 resetSliders();
 
-                emit fileOpened(filePath, curr_img.size(), curr_img.bitPlaneCount(), {});
+                emit fileOpened(filePath, curr_img.size(), curr_img.bitPlaneCount());
 
                 return;
             }
@@ -130,10 +141,11 @@ void Image5DViewer::openFile()
         ui->c_sbox->setValue(0);
         ui->t_sbox->setValue(0);
 
+        // the loader owns the reader from the first request on, the series metadata comes with its planes
+        QSize size(reader->getSizeX(), reader->getSizeY());
+        auto depth = reader->getBitsPerPixel();
         update(true);
-
-        emit fileOpened(filePath, curr_img.size(), reader->getBitsPerPixel(),
-                        QString::fromStdString(reader->getMetaXML()));
+        emit fileOpened(filePath, size, depth);
     }
 }
 
@@ -174,34 +186,63 @@ void Image5DViewer::update(bool is_slider)
         ui->t_sbox->setValue(t);
     }
 
-    reader->setSeries(s);
-
-    auto plane = reader->getPlaneIndex(z, c, t);
-    ui->status->setText(QString("plane: %1 (s = %2, z = %3, c = %4, t = %5)").arg(plane).arg(s).arg(z).arg(c).arg(t));
+    // the last frame stays on screen until the plane arrives, requests overtaken by newer ones are dropped
+    loader->request(s, z, c, t, ui->clip_sbox->value());
+}
 
-    auto x_size = reader->getSizeX();
-    auto y_size = reader->getSizeY();
-    if (auto size = (long long)x_size * y_size * (reader->getRGBChannelCount()) * (reader->getBytesPerPixel());
-        size < 0 || size > 2147483647) // 2GB
+void Image5DViewer::onPlaneLoaded(PlaneLoader::Plane const& plane)
+{
+    ui->status->setText(QString("plane: %1 (s = %2, z = %3, c = %4, t = %5)")
+                            .arg(plane.index)
+                            .arg(plane.series)
+                            .arg(plane.z)
+                            .arg(plane.c)
+                            .arg(plane.t));
+    if (plane.metadata && plane.metadata != curr_plane.metadata) emit seriesChanged(plane.series, *plane.metadata);
+    if (plane.image.isNull()) return;
+
+    if (open_timer.isValid())
     {
-        // TODO: read higher resolution in tiles
-        //auto tile_x_size = reader->getOptimalTileWidth();
-        //auto tile_y_size = reader->getOptimalTileHeight();
-        //auto tiles_x = x_size / tile_x_size / 2;
-        //auto tiles_y = y_size / tile_y_size / 2;
-        //qDebug() << "image size(" << x_size << "," << y_size << ") is too large, load tile size(" << tile_x_size << ","
-        //         << tile_y_size << ")"
-        //         << "at [" << tiles_x << "," << tiles_y << "] instead ";
-        //curr_img = readPlaneTileToQimage(*reader, plane, tiles_x, tiles_y);
-
-        auto levels = reader->getResolutionCount();
-        reader->setResolution(levels - 1); // set to the lowest resolution
-        qDebug() << "levels:" << levels << ", size:" << reader->getSizeX() << reader->getSizeY();
-        curr_img = readPlaneToQimage(*reader, plane);
+        if (!first_pixels)
+            qDebug() << "time to first pixel:" << open_timer.elapsed() << "ms" << (plane.preview ? "(preview)" : "");
+        else if (!plane.preview)
+            qDebug() << "full plane after" << open_timer.elapsed() << "ms";
+        first_pixels = true;
+        if (!plane.preview) open_timer.invalidate();
     }
+
+    // another plane of the same slide keeps the zoom
+    auto same_slide = !plane.levels.isEmpty() && plane.series == curr_plane.series && plane.levels == curr_plane.levels;
+    curr_plane = plane;
+    curr_img = plane.image;
+    // the clip changed while the plane was converted
+    if (plane.histogram && plane.clip != ui->clip_sbox->value())
+        render(!same_slide);
+    else if (plane.levels.isEmpty())
+        ui->viewer->loadImage(curr_img);
+    else if (same_slide)
+        ui->viewer->resetTiles(curr_img);
     else
-        curr_img = readPlaneToQimage(*reader, plane);
-    ui->viewer->loadImage(curr_img);
+        ui->viewer->loadTiled(curr_img, plane.levels);
+}
+
+void Image5DViewer::render(bool reset_view)
+{
+    if (!curr_plane.bytes || !curr_plane.histogram) return;
+    auto clip = ui->clip_sbox->value();
+    curr_img = windowToQImage(curr_plane.type, curr_plane.bytes.get(), curr_plane.size.width(),
+                              curr_plane.size.height(), curr_plane.histogram->window(clip, clip), curr_plane.lut);
+    if (curr_plane.levels.isEmpty())
+        ui->viewer->loadImage(curr_img);
+    else
+    {
+        // the tiles are read again with the new window
+        loader->setTileClip(clip);
+        if (reset_view)
+            ui->viewer->loadTiled(curr_img, curr_plane.levels);
+        else
+            ui->viewer->resetTiles(curr_img);
+    }
 }
 
 void Image5DViewer::resetSliders()
@@ -1,8 +1,9 @@
 #pragma once
 
+#include <QElapsedTimer>
 #include <QWidget>
 
-class Reader;
+#include "planeloader.hpp"
 
 namespace Ui
 {
@@ -17,16 +18,29 @@ public:
     ~Image5DViewer();
 
 signals:
-    void fileOpened(QString const& path, QSize sz, int depth, QString const& xml);
-    void seriesChanged(int series_no);
+    void fileOpened(QString const& path, QSize sz, int depth);
+    // with the first plane delivered of another series
+    void seriesChanged(int series_no, Reader::MetadataFields const& metadata);
 
 private:
     void openFile();
     void update(bool);
     void resetSliders();
+    void onPlaneLoaded(PlaneLoader::Plane const& plane);
+    // windows the current plane with the clip of `ui->clip_sbox`, no read nor scan of the plane
+    // (whole-slide tiles are read again), `reset_view` resets the zoom of tiled planes
+    void render(bool reset_view);
 
 private:
     Ui::Image5DViewer* ui;
     Reader* reader = nullptr;
     QImage curr_img{};
+
+    // created with the reader, all the plane reads go through it
+    PlaneLoader* loader = nullptr;
+    // last delivered plane, shown until the latest request arrives
+    PlaneLoader::Plane curr_plane{};
+    // from picking a file to its first full plane, to log the time to its first pixels (preview or not)
+    QElapsedTimer open_timer{};
+    bool first_pixels = false;
 };
\ No newline at end of file
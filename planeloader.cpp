@@ -0,0 +1,353 @@
+#include "planeloader.hpp"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+    // whole-slide planes above this size (with several resolutions) are browsed by tiles
+    constexpr long long tiled_plane_size = 512LL << 20;
+    // planes above this size (with several resolutions) are previewed at their lowest resolution while being read
+    constexpr long long preview_plane_size = 64LL << 20;
+
+    quint64 tileKey(int level, QPoint tile)
+    {
+        return (quint64(level) << 48) | (quint64(tile.y()) << 24) | quint64(tile.x());
+    }
+} // namespace
+
+#include "bfwrapper/reader.hpp"
+#include "utils/plane2qimg.hpp"
+
+PlaneLoader::PlaneLoader(Reader* reader, QObject* parent): QObject(parent), m_reader(reader)
+{
+    m_pool.setMaxThreadCount(1);
+    // the worker stays attached to the JVM
+    m_pool.setExpiryTimeout(-1);
+
+    qsizetype budget = 512;
+    if (auto* mb = std::getenv("BIOIMREAD_PLANE_CACHE_MB"); mb && *mb) budget = std::atoll(mb);
+    setCacheBudget(budget);
+}
+
+PlaneLoader::~PlaneLoader()
+{
+    cancel();
+}
+
+void PlaneLoader::request(int series, int z, int c, int t, double clip)
+{
+    auto generation = ++m_generation;
+    // queued requests, prefetches and tiles are stale now
+    m_pool.clear();
+    {
+        std::lock_guard lock(m_tiles_mutex);
+        m_queued_tiles.clear();
+        m_wanted_tiles.clear();
+    }
+
+    // the single axis (z, c or t) that moved since the last request, and which way
+    int axis = -1, step = 1;
+    std::array<int, 4> coords{series, z, c, t};
+    if (coords[0] == m_last[0])
+        for (auto i = 1; i < 4; i++)
+            if (coords[i] != m_last[i])
+            {
+                if (axis != -1)
+                {
+                    axis = -1;
+                    break;
+                }
+                axis = i;
+                step = coords[i] > m_last[i] ? 1 : -1;
+            }
+    m_last = coords;
+
+    Plane plane;
+    plane.series = series;
+    plane.z = z;
+    plane.c = c;
+    plane.t = t;
+    plane.clip = clip;
+    m_pool.start([this, generation, plane, axis, step] { load(generation, plane, axis, step); });
+}
+
+void PlaneLoader::cancel()
+{
+    ++m_generation;
+    m_pool.clear();
+    m_pool.waitForDone();
+    m_queued_tiles.clear();
+    m_wanted_tiles.clear();
+}
+
+void PlaneLoader::reset()
+{
+    cancel();
+    m_planes.clear();
+    m_histograms.clear();
+    m_series = -1;
+    m_last = {-1, -1, -1, -1};
+    m_tile_source.reset();
+}
+
+void PlaneLoader::setCacheBudget(qsizetype megabytes)
+{
+    // the worker may be inserting
+    cancel();
+    m_planes.setMaxCost(std::max<qsizetype>(megabytes, 0) * 1024);
+}
+
+void PlaneLoader::setPrefetchCount(int count)
+{
+    m_prefetch = std::max(count, 0);
+}
+
+void PlaneLoader::select(int series)
+{
+    if (series == m_series) return;
+    m_reader->setSeries(series);
+    m_series = series;
+    m_resolution = 0;
+    m_overview = 0;
+    m_preview_level = -1;
+    m_levels.clear();
+    m_metadata = std::make_shared<Reader::MetadataFields const>(m_reader->getSeriesMetadata(series));
+
+    auto x_size = m_reader->getSizeX();
+    auto y_size = m_reader->getSizeY();
+    auto size = (long long)x_size * y_size * (m_reader->getRGBChannelCount()) * (m_reader->getBytesPerPixel());
+    auto levels = m_reader->getResolutionCount();
+    if (levels > 1 && (size < 0 || size > tiled_plane_size))
+    {
+        for (auto level = 0; level < levels; level++)
+        {
+            setLevel(level);
+            // some readers report whole rows or planes as their optimal tile
+            auto tile_width = m_reader->getOptimalTileWidth();
+            auto tile_height = m_reader->getOptimalTileHeight();
+            if (tile_width < 64 || tile_width > 2048) tile_width = 512;
+            if (tile_height < 64 || tile_height > 2048) tile_height = 512;
+            m_levels.append({QSize(m_reader->getSizeX(), m_reader->getSizeY()), QSize(tile_width, tile_height)});
+        }
+        // planes are read at the lowest resolution, the tiles of the others on demand
+        m_overview = levels - 1;
+        qDebug() << "levels:" << levels << ", overview size:" << m_levels.back().size;
+    }
+    else if (size < 0 || size > 2147483647) // 2GB
+        qDebug() << "plane of" << size << "bytes can not be read at once";
+    else if (levels > 1 && size > preview_plane_size)
+        m_preview_level = levels - 1;
+    setLevel(m_overview);
+}
+
+void PlaneLoader::setLevel(int level)
+{
+    if (level == m_resolution) return;
+    m_reader->setResolution(level);
+    m_resolution = level;
+}
+
+PlaneLoader::Plane PlaneLoader::decode(int index)
+{
+    PlaneKey key{m_series, m_resolution, index};
+    if (auto* cached = m_planes.object(key)) return *cached;
+
+    Plane plane;
+    plane.series = m_series;
+    plane.index = index;
+    plane.size = QSize(m_reader->getSizeX(), m_reader->getSizeY());
+    qsizetype bytes = 0;
+    if (!isWindowable(*m_reader))
+    {
+        plane.image = readPlaneToQimage(*m_reader, index);
+        if (plane.image.isNull()) return plane;
+        bytes = plane.image.sizeInBytes();
+    }
+    else
+    {
+        plane.type = m_reader->getPixelType();
+        plane.lut = planeLut(*m_reader);
+        plane.bytes = m_reader->getPlane(index);
+        if (!plane.bytes) return plane;
+        bytes = m_reader->getPlaneSize();
+
+        // a histogram pass per plane, browsing back to it or changing the clip only re-windows it
+        if (auto* histogram = m_histograms.object(key))
+            plane.histogram = *histogram;
+        else
+        {
+            auto built = std::make_shared<Histogram const>(buildHistogram(
+                plane.type, plane.bytes.get(), static_cast<std::size_t>(plane.size.width()) * plane.size.height()));
+            m_histograms.insert(key, new std::shared_ptr<Histogram const>(built),
+                                std::max<qsizetype>(1, built->counts.size() * sizeof(std::uint64_t) / 1024));
+            plane.histogram = built;
+        }
+    }
+    m_planes.insert(key, new Plane(plane), std::max<qsizetype>(1, bytes / 1024));
+    return plane;
+}
+
+void PlaneLoader::load(quint64 generation, Plane plane, int axis, int step)
+{
+    auto stale = [&] { return generation != m_generation; };
+    if (stale()) return;
+
+    select(plane.series);
+    setLevel(m_overview);
+    plane.index = m_reader->getPlaneIndex(plane.z, plane.c, plane.t);
+    plane.levels = m_levels;
+    plane.metadata = m_metadata;
+    // something to look at while the plane is read
+    if (m_preview_level > 0 && !m_planes.contains({m_series, m_resolution, plane.index}))
+    {
+        auto coarse = plane;
+        coarse.preview = true;
+        coarse.image = preview(plane.index, plane.clip);
+        if (stale()) return;
+        if (!coarse.image.isNull()) deliver(generation, coarse);
+    }
+    auto decoded = decode(plane.index);
+    // a newer request came in during the read
+    if (stale()) return;
+
+    plane.size = decoded.size;
+    plane.image = decoded.image;
+    plane.bytes = decoded.bytes;
+    plane.type = decoded.type;
+    plane.lut = decoded.lut;
+    plane.histogram = decoded.histogram;
+    if (plane.bytes && plane.histogram)
+        plane.image = windowToQImage(plane.type, plane.bytes.get(), plane.size.width(), plane.size.height(),
+                                     plane.histogram->window(plane.clip, plane.clip), plane.lut);
+
+    deliver(generation, plane);
+    prefetch(generation, plane, axis, step);
+}
+
+void PlaneLoader::deliver(quint64 generation, Plane const& plane)
+{
+    // checked again on the GUI thread, a request may come in while this one is queued there
+    QMetaObject::invokeMethod(
+        this,
+        [this, generation, plane] {
+            if (generation != m_generation) return;
+            if (plane.levels.isEmpty())
+                m_tile_source.reset();
+            else
+            {
+                TileSource source{generation, plane.series, plane.index, plane.levels, plane.histogram, {}, plane.lut};
+                if (plane.histogram) source.window = plane.histogram->window(plane.clip, plane.clip);
+                m_tile_source = source;
+            }
+            emit loaded(plane);
+        },
+        Qt::QueuedConnection);
+}
+
+QImage PlaneLoader::preview(int index, double clip)
+{
+    setLevel(m_preview_level);
+    QImage image;
+    if (!isWindowable(*m_reader))
+        image = readPlaneToQimage(*m_reader, index);
+    else if (auto bytes = m_reader->getPlane(index))
+    {
+        auto type = m_reader->getPixelType();
+        auto width = m_reader->getSizeX();
+        auto height = m_reader->getSizeY();
+        auto histogram = buildHistogram(type, bytes.get(), static_cast<std::size_t>(width) * height);
+        image = windowToQImage(type, bytes.get(), width, height, histogram.window(clip, clip), planeLut(*m_reader));
+    }
+    setLevel(m_overview);
+    return image;
+}
+
+void PlaneLoader::prefetch(quint64 generation, Plane const& plane, int axis, int step)
+{
+    std::array<int, 4> sizes{0, m_reader->getSizeZ(), m_reader->getSizeC(), m_reader->getSizeT()};
+    // Z when nothing moved yet (first plane of a series), T for a single section
+    if (axis == -1) axis = sizes[1] > 1 ? 1 : 3;
+    std::array<int, 4> coords{plane.series, plane.z, plane.c, plane.t};
+
+    // alternating sides, the direction of travel first
+    for (auto i = 1; i <= m_prefetch; i++)
+        for (auto offset : {i * step, -i * step})
+        {
+            auto neighbour = coords;
+            neighbour[axis] += offset;
+            if (neighbour[axis] < 0 || neighbour[axis] >= sizes[axis]) continue;
+            // dropped with the other queued work by the next request
+            m_pool.start([this, generation, neighbour] {
+                if (generation != m_generation) return;
+                select(neighbour[0]);
+                setLevel(m_overview);
+                decode(m_reader->getPlaneIndex(neighbour[1], neighbour[2], neighbour[3]));
+            });
+        }
+}
+
+void PlaneLoader::requestTiles(int level, QList<QPoint> const& tiles)
+{
+    if (!m_tile_source || level < 0 || level >= m_tile_source->levels.size()) return;
+    auto generation = m_tile_source->generation;
+    auto tile_generation = m_tile_generation.load();
+    std::lock_guard lock(m_tiles_mutex);
+    m_wanted_tiles.clear();
+    for (auto tile : tiles)
+    {
+        auto key = tileKey(level, tile);
+        m_wanted_tiles.insert(key);
+        if (m_queued_tiles.contains(key)) continue;
+        m_queued_tiles.insert(key);
+        // ahead of the prefetches
+        m_pool.start([this, generation, tile_generation, source = *m_tile_source, level,
+                      tile] { loadTile(generation, tile_generation, source, level, tile); },
+                     1);
+    }
+}
+
+void PlaneLoader::setTileClip(double clip)
+{
+    ++m_tile_generation;
+    {
+        std::lock_guard lock(m_tiles_mutex);
+        m_queued_tiles.clear();
+        m_wanted_tiles.clear();
+    }
+    if (m_tile_source && m_tile_source->histogram) m_tile_source->window = m_tile_source->histogram->window(clip, clip);
+}
+
+void PlaneLoader::loadTile(quint64 generation, quint64 tile_generation, TileSource const& source, int level,
+                           QPoint tile)
+{
+    {
+        std::lock_guard lock(m_tiles_mutex);
+        auto key = tileKey(level, tile);
+        m_queued_tiles.remove(key);
+        // scrolled out of view
+        if (!m_wanted_tiles.contains(key)) return;
+    }
+    auto stale = [&] { return generation != m_generation || tile_generation != m_tile_generation; };
+    if (stale()) return;
+
+    select(source.series);
+    setLevel(level);
+    auto [size, tile_size] = source.levels[level];
+    auto x = tile.x() * tile_size.width();
+    auto y = tile.y() * tile_size.height();
+    auto w = std::min(tile_size.width(), size.width() - x);
+    auto h = std::min(tile_size.height(), size.height() - y);
+    // a null tile is not requested again
+    QImage image;
+    if (w > 0 && h > 0) image = readRegionToQimage(*m_reader, source.index, x, y, w, h, source.window, source.lut);
+
+    QMetaObject::invokeMethod(
+        this,
+        [this, generation, tile_generation, level, tile, image] {
+            if (generation == m_generation && tile_generation == m_tile_generation) emit tileLoaded(level, tile, image);
+        },
+        Qt::QueuedConnection);
+}
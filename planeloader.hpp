@@ -0,0 +1,156 @@
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QObject>
+#include <QThreadPool>
+
+#include <QSet>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "image2dviewer.hpp"
+#include "utils/histogram.hpp"
+
+// reads and converts the planes shown by `Image5DViewer` off the GUI thread, one request at a time:
+// every request bumps a generation and only the latest one is delivered, older ones are dropped
+// before being read (still queued) or before being converted / delivered (read in flight).
+// Decoded planes are kept in a memory budgeted cache and the neighbours of the requested plane along the axis
+// being scrubbed are prefetched into it, so that stepping through Z / T runs at display rate once warm.
+// Whole-slide planes are delivered as the overview of their lowest resolution plus their `levels`, the tiles of
+// which are then read on demand (`requestTiles`). Other large planes with several resolutions are delivered twice
+// when they are not cached: their lowest resolution as a `preview` first, then the plane itself.
+class PlaneLoader: public QObject
+{
+    Q_OBJECT
+public:
+    struct Plane
+    {
+        int series{};
+        int z{};
+        int c{};
+        int t{};
+        // plane number
+        int index{-1};
+        // clip of the request, see `Histogram::window`
+        double clip{};
+        // null if the plane could not be read
+        QImage image{};
+        // raw samples of single channel planes (see `isWindowable`) to re-window `image`, null for the others
+        std::shared_ptr<char[]> bytes{};
+        Reader::PixelType type{};
+        QSize size{};
+        QList<uint> lut{};
+        std::shared_ptr<Histogram const> histogram{};
+        // resolutions of a tiled plane, full one first, `image` being the last one; empty for the others
+        QList<TileLevel> levels{};
+        // coarse `image` only (windowed on its own), the plane follows in another delivery
+        bool preview{};
+        // of `series`, see `Reader::getSeriesMetadata`
+        std::shared_ptr<Reader::MetadataFields const> metadata{};
+    };
+
+    // `reader` is only used by the worker while requests are pending
+    explicit PlaneLoader(Reader* reader, QObject* parent = nullptr);
+    ~PlaneLoader();
+
+    void request(int series, int z, int c, int t, double clip);
+    // drops the pending requests and waits for the one being read, the caller can then use the reader
+    // (e.g. to open another file) until the next `request`
+    void cancel();
+    // `cancel` and forgets the planes / histograms of the current file
+    void reset();
+
+    // decoded planes kept, defaults to the `BIOIMREAD_PLANE_CACHE_MB` environment variable or 512MB;
+    // `cancel`s the pending requests
+    void setCacheBudget(qsizetype megabytes);
+    // neighbours prefetched on each side of a requested plane, 0 disables the prefetch
+    void setPrefetchCount(int count);
+
+    // tiles of the last delivered tiled plane, the ones of a previous call still queued are dropped
+    void requestTiles(int level, QList<QPoint> const& tiles);
+    // windows the tiles requested from now on with `clip` (see `Histogram::window`)
+    void setTileClip(double clip);
+
+signals:
+    void loaded(PlaneLoader::Plane const& plane);
+    void tileLoaded(int level, QPoint tile, QImage const& image);
+
+private:
+    struct PlaneKey
+    {
+        int series;
+        int resolution;
+        int index;
+
+        bool operator==(PlaneKey const&) const = default;
+        friend size_t qHash(PlaneKey const& key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.series, key.resolution, key.index);
+        }
+    };
+
+    // what the tiles of the last delivered tiled plane are read with
+    struct TileSource
+    {
+        // of the request the plane was delivered for
+        quint64 generation;
+        int series;
+        int index;
+        QList<TileLevel> levels;
+        std::shared_ptr<Histogram const> histogram;
+        IntensityRange window;
+        QList<uint> lut;
+    };
+
+    void load(quint64 generation, Plane plane, int axis, int step);
+    // emits `loaded` on the GUI thread unless a newer request came in
+    void deliver(quint64 generation, Plane const& plane);
+    // plane `index` of the selected series read at `m_preview_level`, windowed with `clip`
+    QImage preview(int index, double clip);
+    void prefetch(quint64 generation, Plane const& plane, int axis, int step);
+    void loadTile(quint64 generation, quint64 tile_generation, TileSource const& source, int level, QPoint tile);
+    // moves the reader to `series` unless it is there already, finds its levels if it is a whole-slide one and
+    // reads its metadata
+    void select(int series);
+    // moves the reader to resolution `level` of the selected series unless it is there already
+    void setLevel(int level);
+    // plane `index` of the selected series from the cache, read and cached otherwise, without `image` for the
+    // single channel ones
+    Plane decode(int index);
+
+private:
+    Reader* m_reader;
+    // a single thread, the reader is not thread safe
+    QThreadPool m_pool;
+    std::atomic<quint64> m_generation = 0;
+    std::atomic<int> m_prefetch = 4;
+    // last request, to find the axis being scrubbed
+    std::array<int, 4> m_last{-1, -1, -1, -1};
+    // GUI thread only
+    std::optional<TileSource> m_tile_source;
+
+    // bumped by `setTileClip`, tiles windowed otherwise are dropped
+    std::atomic<quint64> m_tile_generation = 0;
+    std::mutex m_tiles_mutex;
+    // `tileKey`s of the tiles queued / still wanted
+    QSet<quint64> m_queued_tiles;
+    QSet<quint64> m_wanted_tiles;
+
+    // only used by the worker
+    int m_series = -1;
+    int m_resolution = 0;
+    // resolution planes are read at, the lowest one for whole-slide series
+    int m_overview = 0;
+    // resolution of the previews of the selected series, -1 if its planes are read without one
+    int m_preview_level = -1;
+    QList<TileLevel> m_levels;
+    std::shared_ptr<Reader::MetadataFields const> m_metadata;
+    // cost in KB
+    QCache<PlaneKey, Plane> m_planes;
+    QCache<PlaneKey, std::shared_ptr<Histogram const>> m_histograms{32 * 1024};
+};
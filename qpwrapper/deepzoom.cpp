@@ -1,7 +1,13 @@
 #include "deepzoom.hpp"
 #include "reader.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <numeric>
+#include <thread>
+#include <unordered_map>
 #include <cmath>
 
 //#define DEBUG_PRINT
@@ -27,8 +33,9 @@ template <typename T> std::ostream& operator<<(std::ostream& os, std::vector<T>
 
 DeepZoomGenerator::DeepZoomGenerator(std::string filepath, int tile_size, int overlap, ImageFormat format,
                                      float quality)
-    : m_tile_size(tile_size), m_overlap(overlap), m_format(format), m_quality(quality)
+    : m_filepath(filepath), m_tile_size(tile_size), m_overlap(overlap), m_format(format), m_quality(quality)
 {
+    m_cache = std::make_unique<TileCache>(default_cache_size);
     m_reader = std::make_unique<Reader>(filepath);
     m_reader->open();
 
@@ -96,6 +103,139 @@ DeepZoomGenerator::DeepZoomGenerator(std::string filepath, int tile_size, int ov
 #endif
 }
 
+// fixed set of threads each owning a `Reader` on the slide, fed from a FIFO of tile keys
+struct DeepZoomGenerator::workers
+{
+    using Bytes = std::vector<unsigned char>;
+
+    struct waiter
+    {
+        TileTicket ticket;
+        TileCallback on_ready;
+    };
+
+    struct request
+    {
+        std::promise<Bytes> promise;
+        std::shared_future<Bytes> future = promise.get_future().share();
+        std::vector<waiter> waiters;
+        bool started = false;
+    };
+
+    workers(DeepZoomGenerator const& dz, int count): dz(dz)
+    {
+        for (auto i = 0; i < count; i++)
+            threads.emplace_back([this] { run(); });
+    }
+
+    ~workers()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto& thread : threads)
+            thread.join();
+        // nothing reads the remaining requests anymore
+        for (auto& [key, req] : requests)
+        {
+            for (auto const& waiter : req->waiters)
+                if (waiter.on_ready) waiter.on_ready({});
+            req->promise.set_value({});
+        }
+    }
+
+    std::shared_future<Bytes> submit(TileCache::Key const& key, TileCallback on_ready, TileTicket* ticket)
+    {
+        std::lock_guard lock(mutex);
+        auto& req = requests[key];
+        if (!req)
+        {
+            req = std::make_shared<request>();
+            queue.push_back(key);
+            cv.notify_one();
+        }
+        auto id = ++last_ticket;
+        req->waiters.push_back({id, std::move(on_ready)});
+        if (ticket) *ticket = id;
+        return req->future;
+    }
+
+    bool cancel(TileCache::Key const& key, TileTicket ticket)
+    {
+        std::shared_ptr<request> req;
+        TileCallback on_ready;
+        {
+            std::lock_guard lock(mutex);
+            auto it = requests.find(key);
+            if (it == requests.end() || it->second->started) return false;
+            auto& waiters = it->second->waiters;
+            auto found = std::find_if(waiters.begin(), waiters.end(),
+                                      [ticket](waiter const& w) { return w.ticket == ticket; });
+            if (found == waiters.end()) return false;
+            on_ready = std::move(found->on_ready);
+            waiters.erase(found);
+            // the queued key is skipped by the worker once the request is gone
+            if (waiters.empty())
+            {
+                req = std::move(it->second);
+                requests.erase(it);
+            }
+        }
+        // outside the lock, callbacks may submit again
+        if (on_ready) on_ready({});
+        if (req) req->promise.set_value({});
+        return true;
+    }
+
+    void run()
+    {
+        Reader reader(dz.m_filepath);
+        reader.open();
+
+        while (true)
+        {
+            TileCache::Key key;
+            std::shared_ptr<request> req;
+            {
+                std::unique_lock lock(mutex);
+                cv.wait(lock, [this] { return stop || !queue.empty(); });
+                if (stop) return;
+                key = queue.front();
+                queue.pop_front();
+                auto it = requests.find(key);
+                if (it == requests.end() || it->second->started) continue; // cancelled or duplicate key
+                req = it->second;
+                req->started = true;
+            }
+
+            auto bytes = dz._read_tile(reader, key.dz_level, key.col, key.row);
+            // cached before the request is dropped, so a new request for the key finds it in one or the other
+            if (!bytes.empty()) dz.m_cache->put(key, std::make_shared<Bytes const>(bytes));
+
+            std::vector<waiter> waiters;
+            {
+                std::lock_guard lock(mutex);
+                requests.erase(key);
+                waiters = std::move(req->waiters);
+            }
+            for (auto const& waiter : waiters)
+                if (waiter.on_ready) waiter.on_ready(bytes);
+            req->promise.set_value(std::move(bytes));
+        }
+    }
+
+    DeepZoomGenerator const& dz;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<TileCache::Key> queue;
+    std::unordered_map<TileCache::Key, std::shared_ptr<request>, TileCache::KeyHash> requests;
+    TileTicket last_ticket = 0;
+    bool stop = false;
+};
+
 DeepZoomGenerator::~DeepZoomGenerator() = default;
 
 int DeepZoomGenerator::level_count() const
@@ -115,11 +255,64 @@ std::vector<std::pair<int, int>> DeepZoomGenerator::level_dimensions() const
 
 int DeepZoomGenerator::tile_count() const
 {
-    return std::reduce(m_t_dimensions.cbegin(), m_t_dimensions.cend(), int{1},
-                       [](auto s, auto const& d) { return s + d.first * d.second; });
+    return std::accumulate(m_t_dimensions.cbegin(), m_t_dimensions.cend(), int{0},
+                           [](int s, auto const& d) { return s + d.first * d.second; });
 }
 
 std::vector<unsigned char> DeepZoomGenerator::get_tile(int dz_level, int col, int row) const
+{
+    TileCache::Key key{dz_level, col, row};
+    if (auto tile = m_cache->get(key)) return *tile;
+
+    auto bytes = _read_tile(*m_reader, dz_level, col, row);
+    if (!bytes.empty()) m_cache->put(key, std::make_shared<std::vector<unsigned char> const>(bytes));
+    return bytes;
+}
+
+std::shared_future<std::vector<unsigned char>> DeepZoomGenerator::get_tile_async(int dz_level, int col, int row,
+                                                                                 TileCallback on_ready,
+                                                                                 TileTicket* ticket) const
+{
+    TileCache::Key key{dz_level, col, row};
+    if (ticket) *ticket = 0;
+    if (auto tile = m_cache->get(key))
+    {
+        if (on_ready) on_ready(*tile);
+        std::promise<std::vector<unsigned char>> cached;
+        cached.set_value(*tile);
+        return cached.get_future().share();
+    }
+
+    std::call_once(m_workers_started, [this] { m_workers = std::make_unique<workers>(*this, m_worker_count); });
+    return m_workers->submit(key, std::move(on_ready), ticket);
+}
+
+bool DeepZoomGenerator::cancel_tile(int dz_level, int col, int row, TileTicket ticket) const
+{
+    return m_workers && ticket != 0 && m_workers->cancel({dz_level, col, row}, ticket);
+}
+
+void DeepZoomGenerator::set_worker_count(int workers)
+{
+    m_worker_count = std::max(1, workers);
+}
+
+void DeepZoomGenerator::set_cache_size(std::size_t bytes)
+{
+    m_cache->set_capacity(bytes);
+}
+
+void DeepZoomGenerator::clear_cache()
+{
+    m_cache->clear();
+}
+
+TileCache::Stats DeepZoomGenerator::cache_stats() const
+{
+    return m_cache->stats();
+}
+
+std::vector<unsigned char> DeepZoomGenerator::_read_tile(Reader& reader, int dz_level, int col, int row) const
 {
     auto [info, z_size] = _get_tile_info(dz_level, col, row);
     auto const& [l0_location, slide_level, l_size] = info;
@@ -136,10 +329,10 @@ std::vector<unsigned char> DeepZoomGenerator::get_tile(int dz_level, int col, in
     std::cout << "z_size: " << z_size << std::endl;
 #endif
     // note: need use width and height in level 0 (see `qpwrapper's readRegion`)
-    return m_reader->readRegion(m_level_0_dz_downsamples[dz_level], xx, yy,
-                                static_cast<int>(std::ceil(width * level_downsample)),
-                                static_cast<int>(std::ceil(height * level_downsample)), 0, 0,
-                                static_cast<Reader::ImageFormat>(m_format), m_quality);
+    return reader.readRegion(m_level_0_dz_downsamples[dz_level], xx, yy,
+                             static_cast<int>(std::ceil(width * level_downsample)),
+                             static_cast<int>(std::ceil(height * level_downsample)), 0, 0,
+                             static_cast<Reader::ImageFormat>(m_format), m_quality);
 
     // auto [originalWidth, originalHeight] = m_l_dimensions[0];
     // double factor = m_level_0_dz_downsamples[dz_level];
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
 #include <utility>
+#include <functional>
+#include <future>
+
+#include "tilecache.hpp"
 
 class Reader;
 
@@ -25,8 +30,9 @@ public:
     DeepZoomGenerator(DeepZoomGenerator const&) = delete;
     DeepZoomGenerator& operator=(DeepZoomGenerator const&) = delete;
 
-    DeepZoomGenerator(DeepZoomGenerator&&) = default;
-    DeepZoomGenerator& operator=(DeepZoomGenerator&&) = default;
+    // async workers keep a reference to the generator
+    DeepZoomGenerator(DeepZoomGenerator&&) = delete;
+    DeepZoomGenerator& operator=(DeepZoomGenerator&&) = delete;
 
     // deepzoom levels
     int level_count() const;
@@ -35,8 +41,24 @@ public:
     // deepzoom level dimensions <x, y>
     std::vector<std::pair<int, int>> level_dimensions() const;
     int tile_count() const;
-    // PNG/JPG bytes
+    // PNG/JPG bytes, served from the tile cache when possible
     std::vector<unsigned char> get_tile(int dz_level, int col, int row) const;
+
+    // called once on the worker thread (or the calling one on a cache hit / `cancel_tile`), empty bytes if the read
+    // failed or was cancelled
+    using TileCallback = std::function<void(std::vector<unsigned char> const&)>;
+    // identifies one `get_tile_async` request for `cancel_tile`, 0 for the ones served from the cache
+    using TileTicket = std::uint64_t;
+    // same as `get_tile` but read by one of the worker threads, each with its own `Reader`,
+    // concurrent requests for the same tile share one read
+    std::shared_future<std::vector<unsigned char>> get_tile_async(int dz_level, int col, int row,
+                                                                  TileCallback on_ready = {},
+                                                                  TileTicket* ticket = nullptr) const;
+    // withdraws the `get_tile_async` request of `ticket` unless its read started: its callback is called with empty
+    // bytes right away, the read is dropped once nobody waits for it; false if there was nothing to withdraw
+    bool cancel_tile(int dz_level, int col, int row, TileTicket ticket) const;
+    // workers are started on the first `get_tile_async`, changing the count afterwards has no effect
+    void set_worker_count(int workers);
     // <<x, y>, slide_level, <width, height>>
     std::tuple<std::pair<int, int>, int, std::pair<int, int>> get_tile_coordinates(int dz_level, int col,
                                                                                    int row) const;
@@ -46,6 +68,13 @@ public:
     std::string get_dzi() const;
     double get_mpp() const;
 
+    // encoded tiles cache budget in bytes, 0 disables caching
+    void set_cache_size(std::size_t bytes);
+    void clear_cache();
+    TileCache::Stats cache_stats() const;
+
+    static constexpr std::size_t default_cache_size = 128 * 1024 * 1024;
+
 private:
     auto _get_tile_info(int dz_level, int col, int row) const
         -> std::pair<std::tuple<std::pair<int, int>, // l0_location
@@ -55,9 +84,12 @@ private:
                      std::pair<int, int> // z_size
                      >;
     auto _get_best_level_for_downsample(double downsample) const -> int;
+    auto _read_tile(Reader& reader, int dz_level, int col, int row) const -> std::vector<unsigned char>;
 
 private:
-    std::unique_ptr<Reader> m_reader = nullptr;
+    std::string m_filepath;
+    std::unique_ptr<Reader> m_reader{};
+    std::unique_ptr<TileCache> m_cache{};
     int m_tile_size =
         512; // the width and height of a single tile, for best viewer performance, tile_size + 2 * overlap should be a power of two
     int m_overlap = 1; // the number of extra pixels to add to each interior edge of a tile
@@ -74,4 +106,9 @@ private:
     std::vector<double>
         m_level_dz_downsamples; // deepzoom level downsample factors (ratio of deepzoom level to slide level)
     std::vector<double> m_level_0_dz_downsamples; // total downsamples for each Deep Zoom level (2 ** x)
+
+    struct workers;
+    int m_worker_count = 4;
+    mutable std::once_flag m_workers_started;
+    mutable std::unique_ptr<workers> m_workers{}; // last, joined before the members it reads are destroyed
 };
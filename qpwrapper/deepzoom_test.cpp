@@ -1,4 +1,5 @@
 #include "deepzoom.hpp"
+#include "stopwatch.hpp"
 
 #include <iostream>
 
@@ -23,6 +24,38 @@ int main(int argc, char* argv[])
     auto str = "data:image/png;base64," + Base64_Encode(png_bytes.data(), png_bytes.size());
     std::cout << str << std::endl;
 
+    // pan over a few tiles of the middle level twice, the second pass is served from the tile cache
+    auto level = slide_handler.level_count() - 2;
+    auto [cols, rows] = slide_handler.level_tiles()[level];
+    auto pan = [&] {
+        for (auto row = 0; row < std::min(rows, 4); row++)
+            for (auto col = 0; col < std::min(cols, 4); col++)
+                slide_handler.get_tile(level, col, row);
+    };
+    {
+        TIME_BLOCK("cold pan");
+        pan();
+    }
+    {
+        TIME_BLOCK("cached pan");
+        pan();
+    }
+    {
+        // a fresh generator so nothing is cached, the same pan on the worker pool (includes opening their readers)
+        DeepZoomGenerator async_handler(url, 254, 1);
+        TIME_BLOCK("async pan");
+        std::vector<std::shared_future<std::vector<unsigned char>>> tiles;
+        for (auto row = 0; row < std::min(rows, 4); row++)
+            for (auto col = 0; col < std::min(cols, 4); col++)
+                tiles.push_back(async_handler.get_tile_async(level, col, row));
+        for (auto const& tile : tiles)
+            tile.wait();
+    }
+    auto stats = slide_handler.cache_stats();
+    std::cout << "tile cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions
+              << " evictions, " << stats.entries << " tiles, " << stats.bytes << " / " << stats.capacity << " bytes"
+              << std::endl;
+
     return 0;
 }
 
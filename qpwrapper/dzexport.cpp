@@ -0,0 +1,287 @@
+#include "deepzoom.hpp"
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <thread>
+
+// renders a whole slide to a static `<output>.dzi` + `<output>_files/<level>/<col>_<row>.<format>` tree:
+// tiles of the deepest level are read by the `DeepZoomGenerator` workers, every other level is downsampled from the
+// already decoded tiles of the level below it, row by row, so only a few tile rows per level are kept in memory
+namespace
+{
+    struct Options
+    {
+        std::string slide;
+        std::filesystem::path output;
+        int tile_size = 254;
+        int overlap = 1;
+        DeepZoomGenerator::ImageFormat format = DeepZoomGenerator::ImageFormat::JPG;
+        float quality = 0.75f;
+        int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    };
+
+    // runs `f(0) ... f(n - 1)` on up to `threads` threads, the calling one included
+    template <typename F> void parallel_for(int n, int threads, F&& f)
+    {
+        std::atomic<int> next = 0;
+        auto work = [&] {
+            for (int i; (i = next++) < n;)
+                f(i);
+        };
+        std::vector<std::thread> pool;
+        for (auto i = 1; i < std::min(threads, n); i++)
+            pool.emplace_back(work);
+        work();
+        for (auto& t : pool)
+            t.join();
+    }
+
+    class PyramidExporter
+    {
+    public:
+        PyramidExporter(DeepZoomGenerator const& dz, Options const& options)
+            : m_dz(dz), m_options(options), m_dimensions(dz.level_dimensions()), m_tiles(dz.level_tiles()),
+              m_levels(m_dimensions.size())
+        {
+            m_ext = m_options.format == DeepZoomGenerator::ImageFormat::PNG ? ".png" : ".jpg";
+            if (m_options.format == DeepZoomGenerator::ImageFormat::JPG)
+                m_params = {cv::IMWRITE_JPEG_QUALITY, static_cast<int>(m_options.quality * 100)};
+            m_files = m_options.output;
+            m_files += "_files";
+        }
+
+        bool run()
+        {
+            for (auto l = 0; l < m_dz.level_count(); l++)
+                std::filesystem::create_directories(m_files / std::to_string(l));
+            std::ofstream(std::filesystem::path(m_options.output) += ".dzi") << m_dz.get_dzi();
+
+            // keep a couple of tile rows in flight so the readers never wait for the downsampling
+            constexpr int lookahead = 2;
+            auto top = m_dz.level_count() - 1;
+            auto rows = m_tiles[top].second;
+            std::map<int, std::vector<std::shared_future<std::vector<unsigned char>>>> pending;
+            for (auto row = 0; row < rows; row++)
+            {
+                for (auto r = row; r < std::min(rows, row + lookahead + 1); r++)
+                    if (!m_staged.contains(r)) read_row(top, r, pending[r]);
+                for (auto const& tile : pending[row])
+                    tile.wait();
+                pending.erase(row);
+                m_levels[top].rows[row] = std::move(m_staged[row]);
+                m_staged.erase(row);
+                if (top > 0) downsample(top - 1);
+            }
+            return m_failed == 0;
+        }
+
+        int written() const { return m_written; }
+        int failed() const { return m_failed; }
+
+    private:
+        // core (overlap stripped) tiles of the rows still needed by the level above
+        struct Level
+        {
+            std::map<int, std::vector<cv::Mat>> rows;
+            int next_row = 0;
+        };
+
+        // pixel span [begin, end) of tile `i` along one axis, overlap included
+        std::pair<int, int> span(int level, int i, bool cols) const
+        {
+            auto size = cols ? m_dimensions[level].first : m_dimensions[level].second;
+            auto count = cols ? m_tiles[level].first : m_tiles[level].second;
+            auto begin = i * m_options.tile_size - (i != 0 ? m_options.overlap : 0);
+            auto end = std::min(size, (i + 1) * m_options.tile_size + (i != count - 1 ? m_options.overlap : 0));
+            return {begin, end};
+        }
+
+        cv::Rect core(int level, int col, int row) const
+        {
+            auto x = col * m_options.tile_size, y = row * m_options.tile_size;
+            return {x, y, std::min(m_options.tile_size, m_dimensions[level].first - x),
+                    std::min(m_options.tile_size, m_dimensions[level].second - y)};
+        }
+
+        bool write(int level, int col, int row, unsigned char const* data, std::size_t size)
+        {
+            auto path = m_files / std::to_string(level) / (std::to_string(col) + "_" + std::to_string(row) + m_ext);
+            std::ofstream file(path, std::ios::binary);
+            file.write(reinterpret_cast<char const*>(data), size);
+            if (!file)
+            {
+                std::cerr << "Error: failed to write " << path << std::endl;
+                return false;
+            }
+            m_written++;
+            return true;
+        }
+
+        cv::Mat decode(std::vector<unsigned char> const& bytes) const
+        {
+            // JPG has no alpha, PNG tiles are normalized to BGRA so every tile of a level has the same type
+            if (m_options.format == DeepZoomGenerator::ImageFormat::JPG) return cv::imdecode(bytes, cv::IMREAD_COLOR);
+            auto image = cv::imdecode(bytes, cv::IMREAD_UNCHANGED);
+            if (image.channels() == 1) cv::cvtColor(image, image, cv::COLOR_GRAY2BGRA);
+            if (image.channels() == 3) cv::cvtColor(image, image, cv::COLOR_BGR2BGRA);
+            return image;
+        }
+
+        cv::Mat blank(cv::Size size) const
+        {
+            auto type = m_options.format == DeepZoomGenerator::ImageFormat::JPG ? CV_8UC3 : CV_8UC4;
+            return cv::Mat(size, type, cv::Scalar::all(255));
+        }
+
+        // tiles are written and decoded by the generator workers as soon as they are read
+        void read_row(int level, int row, std::vector<std::shared_future<std::vector<unsigned char>>>& tiles)
+        {
+            auto cols = m_tiles[level].first;
+            auto& cores = m_staged[row];
+            cores.resize(cols);
+            for (auto col = 0; col < cols; col++)
+            {
+                auto* dst = &cores[col];
+                auto on_ready = [=, this](std::vector<unsigned char> const& bytes) {
+                    auto rect = core(level, col, row);
+                    auto image = bytes.empty() ? cv::Mat() : decode(bytes);
+                    if (image.empty() || !write(level, col, row, bytes.data(), bytes.size()))
+                    {
+                        std::cerr << "Error: failed to export tile " << level << "/" << col << "_" << row << std::endl;
+                        m_failed++;
+                        *dst = blank(rect.size());
+                        return;
+                    }
+                    auto [w, h] = m_dz.get_tile_dimensions(level, col, row);
+                    if (image.cols != w || image.rows != h) cv::resize(image, image, {w, h}, 0, 0, cv::INTER_AREA);
+                    auto x = col != 0 ? m_options.overlap : 0, y = row != 0 ? m_options.overlap : 0;
+                    *dst = image(cv::Rect(x, y, rect.width, rect.height)).clone();
+                };
+                tiles.push_back(m_dz.get_tile_async(level, col, row, on_ready));
+            }
+        }
+
+        // renders every row of `level` whose source rows of `level + 1` are available, then cascades to `level - 1`
+        void downsample(int level)
+        {
+            auto& dst = m_levels[level];
+            auto& src = m_levels[level + 1];
+            auto [cols, rows] = m_tiles[level];
+            auto produced = false;
+            while (dst.next_row < rows)
+            {
+                auto row = dst.next_row;
+                auto [y0, y1] = span(level, row, false);
+                auto last = (std::min(m_dimensions[level + 1].second, 2 * y1) - 1) / m_options.tile_size;
+                if (!src.rows.contains(last)) break;
+
+                std::vector<cv::Mat> cores(cols);
+                parallel_for(cols, m_options.threads, [&](int col) {
+                    auto tile = compose(level, col, row);
+                    std::vector<unsigned char> bytes;
+                    if (!cv::imencode(m_ext, tile, bytes, m_params) ||
+                        !write(level, col, row, bytes.data(), bytes.size()))
+                    {
+                        std::cerr << "Error: failed to export tile " << level << "/" << col << "_" << row << std::endl;
+                        m_failed++;
+                    }
+                    auto rect = core(level, col, row);
+                    auto x = col != 0 ? m_options.overlap : 0, y = row != 0 ? m_options.overlap : 0;
+                    cores[col] = tile(cv::Rect(x, y, rect.width, rect.height)).clone();
+                });
+                if (level > 0) dst.rows[row] = std::move(cores);
+                dst.next_row++;
+                produced = true;
+
+                // source rows above the first one the next row needs are done
+                auto next_y0 = std::max(0, dst.next_row * m_options.tile_size - m_options.overlap);
+                auto first = 2 * next_y0 / m_options.tile_size;
+                std::erase_if(src.rows, [first](auto const& r) { return r.first < first; });
+            }
+            if (produced && level > 0) downsample(level - 1);
+        }
+
+        // tile of `level` (overlap included) from the 2x larger pixels of `level + 1`
+        cv::Mat compose(int level, int col, int row) const
+        {
+            auto [x0, x1] = span(level, col, true);
+            auto [y0, y1] = span(level, row, false);
+            auto const& [src_w, src_h] = m_dimensions[level + 1];
+            cv::Rect area(2 * x0, 2 * y0, std::min(src_w, 2 * x1) - 2 * x0, std::min(src_h, 2 * y1) - 2 * y0);
+
+            auto const& src = m_levels[level + 1].rows;
+            cv::Mat canvas(area.size(), src.at(area.y / m_options.tile_size).front().type());
+            auto ts = m_options.tile_size;
+            for (auto r = area.y / ts; r <= (area.br().y - 1) / ts; r++)
+                for (auto c = area.x / ts; c <= (area.br().x - 1) / ts; c++)
+                {
+                    auto part = core(level + 1, c, r) & area;
+                    auto const& tile = src.at(r)[c];
+                    tile(part - cv::Point(c * ts, r * ts)).copyTo(canvas(part - area.tl()));
+                }
+
+            cv::Mat tile;
+            cv::resize(canvas, tile, {x1 - x0, y1 - y0}, 0, 0, cv::INTER_AREA);
+            return tile;
+        }
+
+    private:
+        DeepZoomGenerator const& m_dz;
+        Options const& m_options;
+        std::vector<std::pair<int, int>> m_dimensions;
+        std::vector<std::pair<int, int>> m_tiles;
+        std::vector<Level> m_levels;
+        std::map<int, std::vector<cv::Mat>> m_staged; // deepest level rows still being read
+        std::filesystem::path m_files;
+        std::string m_ext;
+        std::vector<int> m_params;
+        std::atomic<int> m_written = 0;
+        std::atomic<int> m_failed = 0;
+    };
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <slide path> <output path> [tile size=254] [overlap=1] [jpg|png] [quality=0.75] [threads]"
+                  << std::endl;
+        return -1;
+    }
+
+    Options options;
+    options.slide = argv[1];
+    options.output = argv[2];
+    if (argc > 3) options.tile_size = std::stoi(argv[3]);
+    if (argc > 4) options.overlap = std::stoi(argv[4]);
+    if (argc > 5 && std::string(argv[5]) == "png") options.format = DeepZoomGenerator::ImageFormat::PNG;
+    if (argc > 6) options.quality = std::stof(argv[6]);
+    if (argc > 7) options.threads = std::max(1, std::stoi(argv[7]));
+
+    auto start = std::chrono::steady_clock::now();
+
+    DeepZoomGenerator dz(options.slide, options.tile_size, options.overlap, options.format, options.quality);
+    // every tile is read once, caching them only costs memory
+    dz.set_cache_size(0);
+    dz.set_worker_count(options.threads);
+
+    PyramidExporter exporter(dz, options);
+    auto succeed = exporter.run();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << exporter.written() << " / " << dz.tile_count() << " tiles in " << elapsed.count() << " s, "
+              << exporter.written() / elapsed.count() << " tiles/s";
+    if (!succeed) std::cout << ", " << exporter.failed() << " failed";
+    std::cout << std::endl;
+
+    return succeed ? 0 : 1;
+}
@@ -6,6 +6,7 @@ import java.io.Closeable;
 import java.io.IOException;
 import java.net.URI;
 import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.nio.file.Paths;
 import java.util.Arrays;
 import java.util.Collections;
@@ -34,6 +35,7 @@ public class qpwrapper implements AutoCloseable {
     private ImageServer<BufferedImage> server; // https://github.com/qupath/qupath/blob/main/qupath-core/src/main/java/qupath/lib/images/servers/ImageServer.java
     private ImageServerMetadata meta;
     private PixelCalibration pixcal;
+    private int[] scratch = new int[0]; // ARGB pixels of the last raw region, reused while large enough
 
     public qpwrapper(String path) {
         try {
@@ -394,6 +396,39 @@ public class qpwrapper implements AutoCloseable {
         return null;
     }
 
+    /**
+     * Same as {@link #readRegion(double, int, int, int, int, int, int, String, float)}
+     * but without encoding: the rendered pixels are written to {@code dst} as packed
+     * 8 bits BGRA (little endian ARGB ints), the caller encodes them natively.
+     * 
+     * @param dst direct buffer of at least {@code width * height * 4} bytes of the
+     *            downsampled region
+     * @return [width, height] of the region written to {@code dst}, null on failure
+     */
+    public int[] readRegionRaw(double downsample, int x, int y, int width, int height, int z, int t,
+            ByteBuffer dst) {
+        try {
+            BufferedImage image = server.readRegion(downsample, x, y, width, height, z, t);
+            if (image == null)
+                return null;
+            int w = image.getWidth(), h = image.getHeight();
+            if (dst.capacity() < w * h * 4) {
+                System.err.println(String.format("readRegionRaw: %d bytes buffer is too small for %d x %d pixels",
+                        dst.capacity(), w, h));
+                return null;
+            }
+            if (scratch.length < w * h)
+                scratch = new int[w * h];
+            // same color model conversion as the `drawImage` in `bufferedImageToBytes`, without a second image
+            image.getRGB(0, 0, w, h, scratch, 0, w);
+            dst.order(ByteOrder.LITTLE_ENDIAN).asIntBuffer().put(scratch, 0, w * h);
+            return new int[] { w, h };
+        } catch (Exception e) {
+            e.printStackTrace();
+        }
+        return null;
+    }
+
     /**
      * Read a 2D(+C) image region for a specified z-plane and timepoint.
      * Coordinates and bounding box dimensions are in pixel units, at the full image
@@ -2,13 +2,38 @@
 
 #include "jvmwrapper.hpp"
 
+#include <opencv2/imgcodecs.hpp>
+
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iostream>
 
+namespace
+{
+    // libjpeg-turbo / zlib through OpenCV, instead of `ImageIO` on the JVM heap
+    std::vector<unsigned char> encode(Reader::Region const& region, Reader::ImageFormat format, float quality,
+                                      int png_compression)
+    {
+        std::vector<unsigned char> bytes;
+        if (region.bgra.empty()) return bytes;
+
+        auto jpg_quality = static_cast<int>(std::lround(quality * 100));
+        cv::Mat image(region.height, region.width, CV_8UC4, const_cast<unsigned char*>(region.bgra.data()));
+        // the JPEG encoder drops the alpha channel itself
+        if (format == Reader::ImageFormat::PNG)
+            cv::imencode(".png", image, bytes, {cv::IMWRITE_PNG_COMPRESSION, png_compression});
+        else
+            cv::imencode(".jpg", image, bytes, {cv::IMWRITE_JPEG_QUALITY, jpg_quality});
+        return bytes;
+    }
+} // namespace
+
 struct Reader::impl
 {
     JVMWrapper* jvm_wrapper = nullptr;
-    JNIEnv* jvm_env = nullptr;
+    // looked up per call, a `Reader` may be used from other threads than the one it was created on
+    JNIEnv* jvm_env() const { return JVMWrapper::getJNIEnv(); }
     jclass wrapper_cls = nullptr;       // global reference
     jobject wrapper_instance = nullptr; // global reference
     jclass system_cls = nullptr;        // global reference
@@ -39,6 +64,48 @@ struct Reader::impl
     };
     meta m_meta{};
 
+    // resolved once in `initMethods`, `GetMethodID` is a string lookup and costs more than the call itself
+    struct methods
+    {
+        jmethodID ctor{};
+        jmethodID close{};
+        jmethodID getOMEXML{};
+        jmethodID getSizeX{};
+        jmethodID getSizeY{};
+        jmethodID getSizeZ{};
+        jmethodID getSizeC{};
+        jmethodID getSizeT{};
+        jmethodID getPhysSizeX{};
+        jmethodID getPhysSizeY{};
+        jmethodID getPhysSizeZ{};
+        jmethodID getPhysSizeT{};
+        jmethodID getPixelType{};
+        jmethodID getChannelColor{};
+        jmethodID getChannelName{};
+        jmethodID getBitsPerPixel{};
+        jmethodID getPreferredTileWidth{};
+        jmethodID getPreferredTileHeight{};
+        jmethodID nResolutions{};
+        jmethodID getSizeForResolution{};
+        jmethodID getPreferredDownsamples{};
+        jmethodID getPreferredResolutionLevel{};
+        jmethodID getPreferredDownsampleFactor{};
+        jmethodID readRegionDownsample{};
+        jmethodID readRegionRaw{};
+        jmethodID readRegionLevel{};
+        jmethodID readTile{};
+        jmethodID getDefaultThumbnail{};
+        jmethodID getAssociatedImageNames{};
+        jmethodID getAssociatedImage{};
+        jmethodID gc{}; // static, `java/lang/System`
+    };
+    methods m_methods{};
+
+    bool native_encoding = true;
+    int png_compression = 1; // fast, tiles are small and compress little better at higher levels
+
+    bool initMethods();
+
     void open();
     void close();
     std::string getXML();
@@ -69,6 +136,7 @@ struct Reader::impl
     std::vector<double> getLevelDownsamples();
     int getPreferredResolutionLevel(double downsample);
     double getPreferredDownsampleFactor(double downsample);
+    Region readRegionRaw(double downsample, int x, int y, int w, int h, int z, int t);
     // PNG bytes
     std::vector<unsigned char> readRegion(double downsample, int x, int y, int w, int h, int z, int t,
                                           ImageFormat format, float quality);
@@ -81,38 +149,51 @@ struct Reader::impl
     std::vector<unsigned char> getAssociatedImage(std::string const& name, ImageFormat format, float quality);
 
     void force_gc();
+    // of a failed construction or of the destructor
+    void deleteGlobalRefs();
 };
 
 Reader::Reader(std::string filePath)
 {
     pimpl = std::make_unique<impl>();
+    // failures below leave the JVM up, it is shared with the other readers (pools, servers)
     pimpl->jvm_wrapper = JVMWrapper::getInstance();
-    pimpl->jvm_env = pimpl->jvm_wrapper->getJNIEnv();
+    if (pimpl->jvm_wrapper == nullptr)
+    {
+        std::cerr << "Error: failed to create the JVM." << std::endl;
+        pimpl = nullptr;
+        return;
+    }
     pimpl->wrapper_cls = pimpl->jvm_wrapper->findClass("qpwrapper");
     if (pimpl->wrapper_cls == nullptr)
     {
         std::cerr << "Error: bfwrapper Class not found." << std::endl;
-        pimpl->jvm_wrapper->destroyJVM();
+        pimpl->deleteGlobalRefs();
         pimpl = nullptr;
         return;
     }
     pimpl->system_cls = pimpl->jvm_wrapper->findClass("java/lang/System");
-    jstring filepath = pimpl->jvm_env->NewStringUTF(filePath.c_str());
-    if (auto local_ref = pimpl->jvm_env->NewObject(
-            pimpl->wrapper_cls, pimpl->jvm_wrapper->getMethodID(pimpl->wrapper_cls, "<init>", "(Ljava/lang/String;)V"),
-            filepath);
-        local_ref)
+    if (!pimpl->initMethods())
+    {
+        std::cerr << "Error: qpwrapper Class methods not found." << std::endl;
+        pimpl->deleteGlobalRefs();
+        pimpl = nullptr;
+        return;
+    }
+    jstring filepath = pimpl->jvm_env()->NewStringUTF(filePath.c_str());
+    auto local_ref = pimpl->jvm_env()->NewObject(pimpl->wrapper_cls, pimpl->m_methods.ctor, filepath);
+    pimpl->jvm_env()->DeleteLocalRef(filepath);
+    if (local_ref)
     {
-        pimpl->wrapper_instance = pimpl->jvm_env->NewGlobalRef(local_ref);
-        pimpl->jvm_env->DeleteLocalRef(local_ref);
+        pimpl->wrapper_instance = pimpl->jvm_env()->NewGlobalRef(local_ref);
+        pimpl->jvm_env()->DeleteLocalRef(local_ref);
     }
     else
     {
         std::cerr << "Error: qpwrapper Class instance can not be created." << std::endl;
-        pimpl->jvm_wrapper->destroyJVM();
+        pimpl->deleteGlobalRefs();
         pimpl = nullptr;
     }
-    pimpl->jvm_env->DeleteLocalRef(filepath);
 }
 
 Reader::~Reader()
@@ -120,16 +201,24 @@ Reader::~Reader()
     if (pimpl)
     {
         close();
-        pimpl->jvm_env->DeleteGlobalRef(pimpl->wrapper_cls);
-        pimpl->jvm_env->DeleteGlobalRef(pimpl->wrapper_instance);
-        pimpl->jvm_env->DeleteGlobalRef(pimpl->system_cls);
-        pimpl->wrapper_cls = nullptr;
-        pimpl->wrapper_instance = nullptr;
-        pimpl->system_cls = nullptr;
+        pimpl->deleteGlobalRefs();
     }
     pimpl = nullptr;
 }
 
+void Reader::impl::deleteGlobalRefs()
+{
+    if (auto* env = jvm_env())
+    {
+        if (wrapper_cls) env->DeleteGlobalRef(wrapper_cls);
+        if (wrapper_instance) env->DeleteGlobalRef(wrapper_instance);
+        if (system_cls) env->DeleteGlobalRef(system_cls);
+    }
+    wrapper_cls = nullptr;
+    wrapper_instance = nullptr;
+    system_cls = nullptr;
+}
+
 void Reader::open()
 {
     if (pimpl) pimpl->open();
@@ -284,6 +373,21 @@ double Reader::getPreferredDownsampleFactor(double downsample) const
     return pimpl->getPreferredDownsampleFactor(downsample);
 }
 
+void Reader::setNativeEncoding(bool enabled)
+{
+    pimpl->native_encoding = enabled;
+}
+
+void Reader::setPngCompression(int level)
+{
+    pimpl->png_compression = std::clamp(level, 0, 9);
+}
+
+Reader::Region Reader::readRegionRaw(double downsample, int x, int y, int w, int h, int z, int t) const
+{
+    return pimpl->readRegionRaw(downsample, x, y, w, h, z, t);
+}
+
 std::vector<unsigned char> Reader::readRegion(double downsample, int x, int y, int w, int h, int z, int t,
                                               ImageFormat format, float quality) const
 {
@@ -333,6 +437,51 @@ void Reader::impl::meta::PrintSelf() const
               << "\nphysical_size_t: " << physical_size_t << "\npixel_type: " << pixelTypeStr(pixel_type) << "\n";
 }
 
+bool Reader::impl::initMethods()
+{
+    auto& m = m_methods;
+    bool found = true;
+    auto get = [&](const char* name, const char* sig, jclass cls = nullptr, bool is_static = false) {
+        auto id = jvm_wrapper->getMethodID(cls ? cls : wrapper_cls, name, sig, is_static);
+        found &= (id != nullptr);
+        return id;
+    };
+
+    m.ctor = get("<init>", "(Ljava/lang/String;)V");
+    m.close = get("close", "()V");
+    m.getOMEXML = get("getOMEXML", "()Ljava/lang/String;");
+    m.getSizeX = get("getSizeX", "()I");
+    m.getSizeY = get("getSizeY", "()I");
+    m.getSizeZ = get("getSizeZ", "()I");
+    m.getSizeC = get("getSizeC", "()I");
+    m.getSizeT = get("getSizeT", "()I");
+    m.getPhysSizeX = get("getPhysSizeX", "()D");
+    m.getPhysSizeY = get("getPhysSizeY", "()D");
+    m.getPhysSizeZ = get("getPhysSizeZ", "()D");
+    m.getPhysSizeT = get("getPhysSizeT", "()D");
+    m.getPixelType = get("getPixelType", "()I");
+    m.getChannelColor = get("getChannelColor", "(I)I");
+    m.getChannelName = get("getChannelName", "(I)Ljava/lang/String;");
+    m.getBitsPerPixel = get("getBitsPerPixel", "()I");
+    m.getPreferredTileWidth = get("getPreferredTileWidth", "()I");
+    m.getPreferredTileHeight = get("getPreferredTileHeight", "()I");
+    m.nResolutions = get("nResolutions", "()I");
+    m.getSizeForResolution = get("getSizeForResolution", "(I)[I");
+    m.getPreferredDownsamples = get("getPreferredDownsamples", "()[D");
+    m.getPreferredResolutionLevel = get("getPreferredResolutionLevel", "(D)I");
+    m.getPreferredDownsampleFactor = get("getPreferredDownsampleFactor", "(D)D");
+    m.readRegionDownsample = get("readRegion", "(DIIIIIILjava/lang/String;F)[B");
+    m.readRegionRaw = get("readRegionRaw", "(DIIIIIILjava/nio/ByteBuffer;)[I");
+    m.readRegionLevel = get("readRegion", "(IIIIIIILjava/lang/String;F)[B");
+    m.readTile = get("readTile", "(IIIIIIILjava/lang/String;F)[B");
+    m.getDefaultThumbnail = get("getDefaultThumbnail", "(IILjava/lang/String;F)[B");
+    m.getAssociatedImageNames = get("getAssociatedImageNames", "()[Ljava/lang/String;");
+    m.getAssociatedImage = get("getAssociatedImage", "(Ljava/lang/String;Ljava/lang/String;F)[B");
+    m.gc = get("gc", "()V", system_cls, true);
+
+    return found;
+}
+
 void Reader::impl::open()
 {
     m_meta.size_x = getSizeX();
@@ -363,75 +512,73 @@ void Reader::impl::open()
 
 void Reader::impl::close()
 {
-    jvm_env->CallVoidMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "close", "()V"));
+    jvm_env()->CallVoidMethod(wrapper_instance, m_methods.close);
 }
 
 std::string Reader::impl::getXML()
 {
-    jstring xmldata = (jstring)jvm_env->CallObjectMethod(
-        wrapper_instance, jvm_env->GetMethodID(wrapper_cls, "getOMEXML", "()Ljava/lang/String;"));
+    jstring xmldata = (jstring)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.getOMEXML);
     if (xmldata != nullptr)
     {
-        const char* xmldataChars = jvm_env->GetStringUTFChars(xmldata, nullptr);
+        const char* xmldataChars = jvm_env()->GetStringUTFChars(xmldata, nullptr);
         std::string xml = std::string(xmldataChars);
-        jvm_env->ReleaseStringUTFChars(xmldata, xmldataChars);
+        jvm_env()->ReleaseStringUTFChars(xmldata, xmldataChars);
         return xml;
     }
     else
         std::cerr << "Error retrieving xmldata" << std::endl;
-    jvm_env->DeleteLocalRef(xmldata);
+    jvm_env()->DeleteLocalRef(xmldata);
     return {};
 }
 
 int Reader::impl::getSizeX()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getSizeX", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getSizeX);
 }
 
 int Reader::impl::getSizeY()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getSizeY", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getSizeY);
 }
 
 int Reader::impl::getSizeZ()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getSizeZ", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getSizeZ);
 }
 
 int Reader::impl::getSizeC()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getSizeC", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getSizeC);
 }
 
 int Reader::impl::getSizeT()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getSizeT", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getSizeT);
 }
 
 double Reader::impl::getPhysSizeX()
 {
-    return jvm_env->CallDoubleMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPhysSizeX", "()D"));
+    return jvm_env()->CallDoubleMethod(wrapper_instance, m_methods.getPhysSizeX);
 }
 
 double Reader::impl::getPhysSizeY()
 {
-    return jvm_env->CallDoubleMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPhysSizeY", "()D"));
+    return jvm_env()->CallDoubleMethod(wrapper_instance, m_methods.getPhysSizeY);
 }
 
 double Reader::impl::getPhysSizeZ()
 {
-    return jvm_env->CallDoubleMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPhysSizeZ", "()D"));
+    return jvm_env()->CallDoubleMethod(wrapper_instance, m_methods.getPhysSizeZ);
 }
 
 double Reader::impl::getPhysSizeT()
 {
-    return jvm_env->CallDoubleMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPhysSizeT", "()D"));
+    return jvm_env()->CallDoubleMethod(wrapper_instance, m_methods.getPhysSizeT);
 }
 
 Reader::PixelType Reader::impl::getPixelType()
 {
-    return static_cast<Reader::PixelType>(
-        jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPixelType", "()I")));
+    return static_cast<Reader::PixelType>(jvm_env()->CallIntMethod(wrapper_instance, m_methods.getPixelType));
 }
 
 std::optional<std::array<int, 4>> Reader::impl::getChannelColor(int channel)
@@ -440,8 +587,7 @@ std::optional<std::array<int, 4>> Reader::impl::getChannelColor(int channel)
 
     std::optional<std::array<int, 4>> res;
 
-    jint channelColor = jvm_env->CallIntMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getChannelColor", "(I)I"), channel);
+    jint channelColor = jvm_env()->CallIntMethod(wrapper_instance, m_methods.getChannelColor, channel);
     if (channelColor != -1)
         // https://github.com/qupath/qupath/blob/main/qupath-core/src/main/java/qupath/lib/common/ColorTools.java#L321
         // RGBA
@@ -455,38 +601,35 @@ std::string Reader::impl::getChannelName(int channel)
     assert(channel >= 0 && channel < getSizeC());
 
     std::string channelName;
-    jstring name = (jstring)jvm_env->CallObjectMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getChannelName", "(I)Ljava/lang/String;"), channel);
+    jstring name = (jstring)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.getChannelName, channel);
     if (name != nullptr)
     {
-        const char* nameChars = jvm_env->GetStringUTFChars(name, nullptr);
+        const char* nameChars = jvm_env()->GetStringUTFChars(name, nullptr);
         channelName = std::string(nameChars);
-        jvm_env->ReleaseStringUTFChars(name, nameChars);
+        jvm_env()->ReleaseStringUTFChars(name, nameChars);
     }
-    jvm_env->DeleteLocalRef(name);
+    jvm_env()->DeleteLocalRef(name);
     return channelName;
 }
 
 int Reader::impl::getBitsPerPixel()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getBitsPerPixel", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getBitsPerPixel);
 }
 
 int Reader::impl::getOptimalTileWidth()
 {
-    return jvm_env->CallIntMethod(wrapper_instance,
-                                  jvm_wrapper->getMethodID(wrapper_cls, "getPreferredTileWidth", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getPreferredTileWidth);
 }
 
 int Reader::impl::getOptimalTileHeight()
 {
-    return jvm_env->CallIntMethod(wrapper_instance,
-                                  jvm_wrapper->getMethodID(wrapper_cls, "getPreferredTileHeight", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getPreferredTileHeight);
 }
 
 int Reader::impl::getLevelCount()
 {
-    return jvm_env->CallIntMethod(wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "nResolutions", "()I"));
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.nResolutions);
 }
 
 std::vector<std::pair<int, int>> Reader::impl::getLevelDimensions()
@@ -494,14 +637,13 @@ std::vector<std::pair<int, int>> Reader::impl::getLevelDimensions()
     std::vector<std::pair<int, int>> res;
     for (auto i = 0; i < getLevelCount(); i++)
     {
-        jintArray dims = (jintArray)jvm_env->CallObjectMethod(
-            wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getSizeForResolution", "(I)[I"), i);
+        jintArray dims = (jintArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.getSizeForResolution, i);
         if (dims)
         {
-            jint* dims_ptr = jvm_env->GetIntArrayElements(dims, nullptr);
+            jint* dims_ptr = jvm_env()->GetIntArrayElements(dims, nullptr);
             res.push_back(std::make_pair(dims_ptr[0], dims_ptr[1]));
-            jvm_env->ReleaseIntArrayElements(dims, dims_ptr, 0);
-            jvm_env->DeleteLocalRef(dims);
+            jvm_env()->ReleaseIntArrayElements(dims, dims_ptr, 0);
+            jvm_env()->DeleteLocalRef(dims);
         }
         else
             res.push_back(std::make_pair(-1, -1));
@@ -512,46 +654,72 @@ std::vector<std::pair<int, int>> Reader::impl::getLevelDimensions()
 std::vector<double> Reader::impl::getLevelDownsamples()
 {
     std::vector<double> res;
-    jdoubleArray downsamples = (jdoubleArray)jvm_env->CallObjectMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPreferredDownsamples", "()[D"));
+    jdoubleArray downsamples =
+        (jdoubleArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.getPreferredDownsamples);
     if (downsamples)
     {
-        jsize length = jvm_env->GetArrayLength(downsamples);
+        jsize length = jvm_env()->GetArrayLength(downsamples);
         res.resize(length);
-        jvm_env->GetDoubleArrayRegion(downsamples, 0, length, (jdouble*)res.data());
+        jvm_env()->GetDoubleArrayRegion(downsamples, 0, length, (jdouble*)res.data());
     }
-    jvm_env->DeleteLocalRef(downsamples);
+    jvm_env()->DeleteLocalRef(downsamples);
     return res;
 }
 
 int Reader::impl::getPreferredResolutionLevel(double downsample)
 {
-    return jvm_env->CallIntMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPreferredResolutionLevel", "(D)I"), downsample);
+    return jvm_env()->CallIntMethod(wrapper_instance, m_methods.getPreferredResolutionLevel, downsample);
 }
 double Reader::impl::getPreferredDownsampleFactor(double downsample)
 {
-    return jvm_env->CallDoubleMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getPreferredDownsampleFactor", "(D)D"), downsample);
+    return jvm_env()->CallDoubleMethod(wrapper_instance, m_methods.getPreferredDownsampleFactor, downsample);
+}
+
+Reader::Region Reader::impl::readRegionRaw(double downsample, int x, int y, int w, int h, int z, int t)
+{
+    Region region;
+
+    // `QuPath` rounds the downsampled size, one extra pixel per side is always enough
+    auto capacity = (static_cast<std::size_t>(std::ceil(w / downsample)) + 1) *
+                    (static_cast<std::size_t>(std::ceil(h / downsample)) + 1) * 4;
+    region.bgra.resize(capacity);
+    jobject buffer = jvm_env()->NewDirectByteBuffer(region.bgra.data(), static_cast<jlong>(capacity));
+    jintArray size = (jintArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.readRegionRaw, downsample, x,
+                                                            y, w, h, z, t, buffer);
+    if (size != nullptr)
+    {
+        jint dims[2];
+        jvm_env()->GetIntArrayRegion(size, 0, 2, dims);
+        region.width = dims[0];
+        region.height = dims[1];
+        region.bgra.resize(static_cast<std::size_t>(region.width) * region.height * 4);
+    }
+    else
+        region.bgra.clear();
+    jvm_env()->DeleteLocalRef(size);
+    jvm_env()->DeleteLocalRef(buffer);
+
+    return region;
 }
 
 std::vector<unsigned char> Reader::impl::readRegion(double downsample, int x, int y, int w, int h, int z, int t,
                                                     ImageFormat format, float quality)
 {
+    if (native_encoding) return encode(readRegionRaw(downsample, x, y, w, h, z, t), format, quality, png_compression);
+
     std::vector<unsigned char> bytes;
 
-    jstring formatStr = jvm_env->NewStringUTF((format == ImageFormat::PNG) ? "PNG" : "JPG");
-    jbyteArray byteArray = (jbyteArray)jvm_env->CallObjectMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "readRegion", "(DIIIIIILjava/lang/String;F)[B"),
-        downsample, x, y, w, h, z, t, formatStr, quality);
+    jstring formatStr = jvm_env()->NewStringUTF((format == ImageFormat::PNG) ? "PNG" : "JPG");
+    jbyteArray byteArray = (jbyteArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.readRegionDownsample,
+                                                                   downsample, x, y, w, h, z, t, formatStr, quality);
     if (byteArray != nullptr)
     {
-        jsize len = jvm_env->GetArrayLength(byteArray);
+        jsize len = jvm_env()->GetArrayLength(byteArray);
         bytes.resize(len);
-        jvm_env->GetByteArrayRegion(byteArray, 0, len, (jbyte*)bytes.data());
+        jvm_env()->GetByteArrayRegion(byteArray, 0, len, (jbyte*)bytes.data());
     }
-    jvm_env->DeleteLocalRef(byteArray);
-    jvm_env->DeleteLocalRef(formatStr);
+    jvm_env()->DeleteLocalRef(byteArray);
+    jvm_env()->DeleteLocalRef(formatStr);
 
     return bytes;
 }
@@ -559,20 +727,23 @@ std::vector<unsigned char> Reader::impl::readRegion(double downsample, int x, in
 std::vector<unsigned char> Reader::impl::readRegion(int level, int x, int y, int w, int h, int z, int t,
                                                     ImageFormat format, float quality)
 {
+    // same as `qpwrapper.readRegion(int level, ...)`, the downsamples are known once opened
+    if (native_encoding && level >= 0 && level < static_cast<int>(m_meta.level_downsamples.size()))
+        return readRegion(m_meta.level_downsamples[level], x, y, w, h, z, t, format, quality);
+
     std::vector<unsigned char> bytes;
 
-    jstring formatStr = jvm_env->NewStringUTF((format == ImageFormat::PNG) ? "PNG" : "JPG");
-    jbyteArray byteArray = (jbyteArray)jvm_env->CallObjectMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "readRegion", "(IIIIIIILjava/lang/String;F)[B"), level,
-        x, y, w, h, z, t, formatStr, quality);
+    jstring formatStr = jvm_env()->NewStringUTF((format == ImageFormat::PNG) ? "PNG" : "JPG");
+    jbyteArray byteArray = (jbyteArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.readRegionLevel, level,
+                                                                   x, y, w, h, z, t, formatStr, quality);
     if (byteArray != nullptr)
     {
-        jsize len = jvm_env->GetArrayLength(byteArray);
+        jsize len = jvm_env()->GetArrayLength(byteArray);
         bytes.resize(len);
-        jvm_env->GetByteArrayRegion(byteArray, 0, len, (jbyte*)bytes.data());
+        jvm_env()->GetByteArrayRegion(byteArray, 0, len, (jbyte*)bytes.data());
     }
-    jvm_env->DeleteLocalRef(byteArray);
-    jvm_env->DeleteLocalRef(formatStr);
+    jvm_env()->DeleteLocalRef(byteArray);
+    jvm_env()->DeleteLocalRef(formatStr);
 
     return bytes;
 }
@@ -582,18 +753,17 @@ std::vector<unsigned char> Reader::impl::readTile(int level, int x, int y, int w
 {
     std::vector<unsigned char> bytes;
 
-    jstring formatStr = jvm_env->NewStringUTF((format == ImageFormat::PNG) ? "PNG" : "JPG");
-    jbyteArray byteArray = (jbyteArray)jvm_env->CallObjectMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "readTile", "(IIIIIIILjava/lang/String;F)[B"), level, x,
-        y, w, h, z, t, formatStr, quality);
+    jstring formatStr = jvm_env()->NewStringUTF((format == ImageFormat::PNG) ? "PNG" : "JPG");
+    jbyteArray byteArray = (jbyteArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.readTile, level, x, y, w,
+                                                                   h, z, t, formatStr, quality);
     if (byteArray != nullptr)
     {
-        jsize len = jvm_env->GetArrayLength(byteArray);
+        jsize len = jvm_env()->GetArrayLength(byteArray);
         bytes.resize(len);
-        jvm_env->GetByteArrayRegion(byteArray, 0, len, (jbyte*)bytes.data());
+        jvm_env()->GetByteArrayRegion(byteArray, 0, len, (jbyte*)bytes.data());
     }
-    jvm_env->DeleteLocalRef(byteArray);
-    jvm_env->DeleteLocalRef(formatStr);
+    jvm_env()->DeleteLocalRef(byteArray);
+    jvm_env()->DeleteLocalRef(formatStr);
 
     return bytes;
 }
@@ -602,18 +772,17 @@ std::vector<unsigned char> Reader::impl::getDefaultThumbnail(int z, int t, Image
 {
     std::vector<unsigned char> bytes;
 
-    jstring formatStr = jvm_env->NewStringUTF((format == ImageFormat::PNG) ? "PNG" : "JPG");
-    jbyteArray byteArray = (jbyteArray)jvm_env->CallObjectMethod(
-        wrapper_instance, jvm_wrapper->getMethodID(wrapper_cls, "getDefaultThumbnail", "(IILjava/lang/String;F)[B"), z,
-        t);
+    jstring formatStr = jvm_env()->NewStringUTF((format == ImageFormat::PNG) ? "PNG" : "JPG");
+    jbyteArray byteArray = (jbyteArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.getDefaultThumbnail, z,
+                                                                   t, formatStr, quality);
     if (byteArray != nullptr)
     {
-        jsize len = jvm_env->GetArrayLength(byteArray);
+        jsize len = jvm_env()->GetArrayLength(byteArray);
         bytes.resize(len);
-        jvm_env->GetByteArrayRegion(byteArray, 0, len, (jbyte*)bytes.data());
+        jvm_env()->GetByteArrayRegion(byteArray, 0, len, (jbyte*)bytes.data());
     }
-    jvm_env->DeleteLocalRef(byteArray);
-    jvm_env->DeleteLocalRef(formatStr);
+    jvm_env()->DeleteLocalRef(byteArray);
+    jvm_env()->DeleteLocalRef(formatStr);
 
     return bytes;
 }
@@ -622,24 +791,24 @@ std::vector<std::string> Reader::impl::getAssociatedImageNames()
 {
     std::vector<std::string> associatedImageNamesVec;
 
-    jobjectArray associatedImageNames = (jobjectArray)jvm_env->CallObjectMethod(
-        wrapper_instance, jvm_env->GetMethodID(wrapper_cls, "getAssociatedImageNames", "()[Ljava/lang/String;"));
+    jobjectArray associatedImageNames =
+        (jobjectArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.getAssociatedImageNames);
     if (associatedImageNames != nullptr)
     {
-        jsize length = jvm_env->GetArrayLength(associatedImageNames);
+        jsize length = jvm_env()->GetArrayLength(associatedImageNames);
         associatedImageNamesVec.reserve(length);
         for (jsize i = 0; i < length; i++)
         {
-            jstring name = (jstring)jvm_env->GetObjectArrayElement(associatedImageNames, i);
-            if (auto* nameChars = jvm_env->GetStringUTFChars(name, nullptr); nameChars)
+            jstring name = (jstring)jvm_env()->GetObjectArrayElement(associatedImageNames, i);
+            if (auto* nameChars = jvm_env()->GetStringUTFChars(name, nullptr); nameChars)
             {
                 associatedImageNamesVec.emplace_back(nameChars);
-                jvm_env->ReleaseStringUTFChars(name, nameChars);
-                jvm_env->DeleteLocalRef(name);
+                jvm_env()->ReleaseStringUTFChars(name, nameChars);
+                jvm_env()->DeleteLocalRef(name);
             }
         }
     }
-    jvm_env->DeleteLocalRef(associatedImageNames);
+    jvm_env()->DeleteLocalRef(associatedImageNames);
 
     return associatedImageNamesVec;
 }
@@ -648,26 +817,24 @@ std::vector<unsigned char> Reader::impl::getAssociatedImage(std::string const& n
 {
     std::vector<unsigned char> bytes;
 
-    jstring nameStr = jvm_env->NewStringUTF(name.c_str());
-    jstring formatStr = jvm_env->NewStringUTF((format == ImageFormat::PNG) ? "PNG" : "JPG");
-    jbyteArray byteArray = (jbyteArray)jvm_env->CallObjectMethod(
-        wrapper_instance,
-        jvm_env->GetMethodID(wrapper_cls, "getAssociatedImage", "(Ljava/lang/String;Ljava/lang/String;F)[B"), nameStr,
-        formatStr, quality);
+    jstring nameStr = jvm_env()->NewStringUTF(name.c_str());
+    jstring formatStr = jvm_env()->NewStringUTF((format == ImageFormat::PNG) ? "PNG" : "JPG");
+    jbyteArray byteArray = (jbyteArray)jvm_env()->CallObjectMethod(wrapper_instance, m_methods.getAssociatedImage,
+                                                                   nameStr, formatStr, quality);
     if (byteArray != nullptr)
     {
-        jsize length = jvm_env->GetArrayLength(byteArray);
+        jsize length = jvm_env()->GetArrayLength(byteArray);
         bytes.resize(length);
-        jvm_env->GetByteArrayRegion(byteArray, 0, length, (jbyte*)bytes.data());
+        jvm_env()->GetByteArrayRegion(byteArray, 0, length, (jbyte*)bytes.data());
     }
-    jvm_env->DeleteLocalRef(byteArray);
-    jvm_env->DeleteLocalRef(formatStr);
-    jvm_env->DeleteLocalRef(nameStr);
+    jvm_env()->DeleteLocalRef(byteArray);
+    jvm_env()->DeleteLocalRef(formatStr);
+    jvm_env()->DeleteLocalRef(nameStr);
 
     return bytes;
 }
 
 void Reader::impl::force_gc()
 {
-    jvm_env->CallStaticVoidMethod(system_cls, jvm_env->GetStaticMethodID(system_cls, "gc", "()V"));
+    jvm_env()->CallStaticVoidMethod(system_cls, m_methods.gc);
 }
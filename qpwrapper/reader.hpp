@@ -27,6 +27,14 @@ public:
         JPEG,
     };
 
+    // rendered region pixels before encoding
+    struct Region
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> bgra; // packed 8 bits BGRA, `width * height * 4` bytes
+    };
+
     static std::string pixelTypeStr(PixelType pixelType);
     static int getBytesPerPixel(PixelType pixelType);
 
@@ -68,6 +76,12 @@ public:
     std::vector<double> getLevelDownsamples() const;
     int getPreferredResolutionLevel(double downsample) const;
     double getPreferredDownsampleFactor(double downsample) const;
+    // regions are encoded in C++ (OpenCV) by default, `false` lets Java `ImageIO` encode them
+    void setNativeEncoding(bool enabled);
+    // zlib level 0-9 of natively encoded PNG regions, JPG quality is the `quality` argument
+    void setPngCompression(int level);
+    // empty region on failure
+    Region readRegionRaw(double downsample, int x, int y, int w, int h, int z, int t) const;
     // PNG bytes
     std::vector<unsigned char> readRegion(double downsample, int x, int y, int w, int h, int z, int t,
                                           ImageFormat format = ImageFormat::PNG, float quality = 0.75f) const;
@@ -1,7 +1,11 @@
 #include "reader.hpp"
+#include "stopwatch.hpp"
 
+#include <algorithm>
 #include <iostream>
 
+//#define BENCH_ENCODE
+
 int main(int argc, char* argv[])
 {
     if (argc != 2)
@@ -38,5 +42,43 @@ int main(int argc, char* argv[])
         std::cout << "Associated image size: " << image.size() << std::endl;
     }
 
+#ifdef BENCH_ENCODE
+    // the same level 0 regions encoded by Java `ImageIO` and by OpenCV,
+    // read once beforehand so both passes are served from the `QuPath` tile cache
+    {
+        auto [w, h] = levelDimensions[0];
+        auto size = std::min({512, w, h});
+        constexpr int regions = 32;
+        auto region = [&](int i, auto&& read) {
+            return read(std::min(i % 8 * size, w - size), std::min(i / 8 * size, h - size));
+        };
+        for (auto i = 0; i < regions; i++)
+            region(i, [&](int x, int y) { return reader.readRegionRaw(1.0, x, y, size, size, 0, 0); });
+        {
+            TIME_BLOCK("raw regions");
+            for (auto i = 0; i < regions; i++)
+                region(i, [&](int x, int y) { return reader.readRegionRaw(1.0, x, y, size, size, 0, 0); });
+        }
+        for (auto format : {Reader::ImageFormat::JPEG, Reader::ImageFormat::PNG})
+        {
+            std::string name = format == Reader::ImageFormat::PNG ? "PNG" : "JPEG";
+            for (auto native : {false, true})
+            {
+                reader.setNativeEncoding(native);
+                std::size_t bytes = 0;
+                {
+                    TIME_BLOCK((native ? "native " : "ImageIO ") + name);
+                    for (auto i = 0; i < regions; i++)
+                        bytes += region(i, [&](int x, int y) {
+                                     return reader.readRegion(1.0, x, y, size, size, 0, 0, format);
+                                 }).size();
+                }
+                std::cout << "  " << regions << " regions of " << size << "x" << size << ": " << bytes << " bytes"
+                          << std::endl;
+            }
+        }
+    }
+#endif
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "tilecache.hpp"
+
+#include <cstdint>
+#include <functional>
+
+TileCache::TileCache(std::size_t capacity): m_capacity(capacity) {}
+
+TileCache::Tile TileCache::get(Key const& key)
+{
+    std::lock_guard lock(m_mutex);
+    auto it = m_index.find(key);
+    if (it == m_index.end())
+    {
+        m_misses++;
+        return nullptr;
+    }
+    m_hits++;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return it->second->second;
+}
+
+void TileCache::put(Key const& key, Tile tile)
+{
+    if (!tile) return;
+
+    std::lock_guard lock(m_mutex);
+    if (tile->size() > m_capacity) return;
+
+    if (auto it = m_index.find(key); it != m_index.end())
+    {
+        m_bytes -= it->second->second->size();
+        m_lru.erase(it->second);
+        m_index.erase(it);
+    }
+    evict(m_capacity - tile->size());
+    m_bytes += tile->size();
+    m_lru.emplace_front(key, std::move(tile));
+    m_index.emplace(key, m_lru.begin());
+}
+
+void TileCache::clear()
+{
+    std::lock_guard lock(m_mutex);
+    m_lru.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
+
+void TileCache::set_capacity(std::size_t capacity)
+{
+    std::lock_guard lock(m_mutex);
+    m_capacity = capacity;
+    evict(m_capacity);
+}
+
+TileCache::Stats TileCache::stats() const
+{
+    std::lock_guard lock(m_mutex);
+    return {m_hits, m_misses, m_evictions, m_index.size(), m_bytes, m_capacity};
+}
+
+std::size_t TileCache::KeyHash::operator()(Key const& key) const
+{
+    // dz levels stay below 64 and tile columns/rows below 2^24 for any slide
+    auto packed = (std::uint64_t(key.dz_level) << 48) ^ (std::uint64_t(key.col) << 24) ^ std::uint64_t(key.row);
+    return std::hash<std::uint64_t>{}(packed);
+}
+
+void TileCache::evict(std::size_t capacity)
+{
+    while (m_bytes > capacity && !m_lru.empty())
+    {
+        auto const& [key, tile] = m_lru.back();
+        m_bytes -= tile->size();
+        m_index.erase(key);
+        m_lru.pop_back();
+        m_evictions++;
+    }
+}
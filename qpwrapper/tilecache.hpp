@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// thread-safe LRU cache of encoded deepzoom tiles, bounded by the total size of the tiles in bytes
+class TileCache
+{
+public:
+    using Tile = std::shared_ptr<std::vector<unsigned char> const>;
+
+    struct Key
+    {
+        int dz_level;
+        int col;
+        int row;
+
+        bool operator==(Key const&) const = default;
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(Key const& key) const;
+    };
+
+    struct Stats
+    {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t evictions = 0;
+        std::size_t entries = 0;
+        std::size_t bytes = 0;
+        std::size_t capacity = 0;
+    };
+
+    explicit TileCache(std::size_t capacity);
+
+    // nullptr on miss
+    Tile get(Key const& key);
+    // tiles larger than the capacity are not cached
+    void put(Key const& key, Tile tile);
+    void clear();
+    // evicts down to the new capacity, 0 disables caching
+    void set_capacity(std::size_t capacity);
+    Stats stats() const;
+
+private:
+    using Entry = std::pair<Key, Tile>;
+
+    void evict(std::size_t capacity);
+
+private:
+    mutable std::mutex m_mutex;
+    std::list<Entry> m_lru; // most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index;
+    std::size_t m_capacity = 0;
+    std::size_t m_bytes = 0;
+    std::size_t m_hits = 0;
+    std::size_t m_misses = 0;
+    std::size_t m_evictions = 0;
+};
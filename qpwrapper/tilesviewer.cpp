@@ -13,6 +13,7 @@
 #include <QWebEngineUrlSchemeHandler>
 #include <QWebEngineUrlRequestJob>
 #include <QWebEngineUrlScheme>
+#include <QPointer>
 
 #include <QMainWindow>
 #include <QToolBar>
@@ -45,45 +46,121 @@ public:
     SlideHandler(QObject* p = nullptr): QObject(p) {}
     ~SlideHandler() = default;
 
+    static constexpr char scheme[] = "dzi";
+
     void setSlide(QString url, int tile_size, int overlap,
                   DeepZoomGenerator::ImageFormat format = DeepZoomGenerator::ImageFormat::JPG, float quality = 0.75f)
     {
         m_format = format;
         m_quality = quality;
+        // tiles still being read for the previous slide keep their generator alive
         m_slide_handler =
-            std::make_unique<DeepZoomGenerator>(url.toStdString(), tile_size, overlap, m_format, m_quality);
+            std::make_shared<DeepZoomGenerator>(url.toStdString(), tile_size, overlap, m_format, m_quality);
+        m_slide_id++;
         m_dzi = QString::fromStdString(m_slide_handler->get_dzi());
-        emit dziChanged(m_dzi);
+        // the id in the url keeps the browser from reusing tiles of the previous slide
+        emit dziChanged(m_dzi, QString("%1:/%2/slide.dzi").arg(scheme).arg(m_slide_id));
         m_mpp = QString::number(m_slide_handler->get_mpp());
         emit mppChanged(m_mpp);
     }
 
-public slots:
-    QString getTileUrl(QString url)
+    // nullptr if `slide_id` is not the current slide
+    std::shared_ptr<DeepZoomGenerator> slide(int slide_id) const
+    {
+        return slide_id == m_slide_id ? m_slide_handler : nullptr;
+    }
+
+    // drops the current slide, its generator joins its workers once the last tile request lets go of it
+    void closeSlide()
     {
-        // qDebug() << Q_FUNC_INFO << ": " << url;
-        auto lxy = url.split("/");
-        auto level = lxy[0].toInt();
-        auto xy = lxy[1].split("_");
-        auto x = xy[0].toInt();
-        auto y = xy[1].toInt();
-
-        auto bytes = m_slide_handler->get_tile(level, x, y);
-        return "data:image/" + QString((m_format == DeepZoomGenerator::ImageFormat::PNG) ? "png" : "jpg") + ";base64," +
-               QByteArray(reinterpret_cast<char*>(bytes.data()), bytes.size()).toBase64();
+        m_slide_handler = nullptr;
+        m_slide_id++;
     }
+
+    QByteArray mimeType() const
+    {
+        return (m_format == DeepZoomGenerator::ImageFormat::PNG) ? "image/png" : "image/jpeg";
+    }
+
 signals:
     void mppChanged(QString mpp);
-    void dziChanged(QString dzi);
+    void dziChanged(QString dzi, QString url);
 
 private:
-    std::unique_ptr<DeepZoomGenerator> m_slide_handler = nullptr;
+    std::shared_ptr<DeepZoomGenerator> m_slide_handler = nullptr;
+    int m_slide_id = 0;
     QString m_mpp = "1e-6";
     QString m_dzi;
     DeepZoomGenerator::ImageFormat m_format = DeepZoomGenerator::ImageFormat::PNG;
     float m_quality = 1.f;
 };
 
+// serves `dzi:/<slide id>/slide_files/<level>/<col>_<row>.<format>` with the raw encoded tile bytes,
+// tiles are read by the generator's workers and replied asynchronously so the browser keeps many requests in flight
+class DziSchemeHandler: public QWebEngineUrlSchemeHandler
+{
+public:
+    DziSchemeHandler(SlideHandler* slides, QObject* p = nullptr): QWebEngineUrlSchemeHandler(p), m_slides(slides) {}
+    ~DziSchemeHandler() override
+    {
+        // the cancel connections of pending jobs share the generator, dropping them and the slide joins its workers
+        // here, before the tile callbacks could outlive the handler
+        QObject::disconnect(nullptr, nullptr, this, nullptr);
+        m_slides->closeSlide();
+    }
+
+    void requestStarted(QWebEngineUrlRequestJob* job) override
+    {
+        auto parts = job->requestUrl().path().split("/", Qt::SkipEmptyParts);
+        auto xy = parts.size() == 4 ? parts[3].section(".", 0, 0).split("_") : QStringList{};
+        if (xy.size() != 2)
+        {
+            job->fail(QWebEngineUrlRequestJob::UrlInvalid);
+            return;
+        }
+        auto slide = m_slides->slide(parts[0].toInt());
+        auto level = parts[2].toInt();
+        auto col = xy[0].toInt();
+        auto row = xy[1].toInt();
+        if (!slide || level < 0 || level >= slide->level_count() || col < 0 ||
+            col >= slide->level_tiles()[level].first || row < 0 || row >= slide->level_tiles()[level].second)
+        {
+            job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+            return;
+        }
+
+        // the browser aborts requests of tiles scrolled out of view, which destroys their job
+        auto ticket = std::make_shared<DeepZoomGenerator::TileTicket>(0);
+        auto cancel = connect(job, &QObject::destroyed, this,
+                              [slide, level, col, row, ticket] { slide->cancel_tile(level, col, row, *ticket); });
+        // called on the generator's workers, posted to the application rather than to the handler it may outlive
+        auto reply = [handler = QPointer(this), job = QPointer(job), cancel,
+                      mime = m_slides->mimeType()](auto const& bytes) {
+            QMetaObject::invokeMethod(
+                qApp,
+                [handler, job, cancel, mime,
+                 data = QByteArray(reinterpret_cast<char const*>(bytes.data()), bytes.size())] {
+                    if (!handler) return;
+                    QObject::disconnect(cancel);
+                    if (!job) return;
+                    if (data.isEmpty())
+                    {
+                        job->fail(QWebEngineUrlRequestJob::RequestFailed);
+                        return;
+                    }
+                    auto* buffer = new QBuffer(job);
+                    buffer->setData(data);
+                    job->reply(mime, buffer);
+                },
+                Qt::QueuedConnection);
+        };
+        slide->get_tile_async(level, col, row, reply, ticket.get());
+    }
+
+private:
+    SlideHandler* m_slides;
+};
+
 int main(int argc, char* argv[])
 {
     using namespace Qt::StringLiterals;
@@ -93,6 +170,13 @@ int main(int argc, char* argv[])
     QLoggingCategory::setFilterRules(u"qt.webenginecontext.debug=true"_s);
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
 
+    // custom schemes must be registered before the application is created
+    QWebEngineUrlScheme scheme(SlideHandler::scheme);
+    scheme.setSyntax(QWebEngineUrlScheme::Syntax::Path);
+    scheme.setFlags(QWebEngineUrlScheme::SecureScheme | QWebEngineUrlScheme::LocalAccessAllowed |
+                    QWebEngineUrlScheme::CorsEnabled);
+    QWebEngineUrlScheme::registerScheme(scheme);
+
     QApplication app(argc, argv);
 
     QMainWindow window;
@@ -108,6 +192,9 @@ int main(int argc, char* argv[])
     auto slide_handler = QSharedPointer<SlideHandler>::create(view.get());
     channel->registerObject("slide_handler", slide_handler.get());
 
+    auto scheme_handler = QSharedPointer<DziSchemeHandler>::create(slide_handler.get());
+    page->profile()->installUrlSchemeHandler(SlideHandler::scheme, scheme_handler.get());
+
     QString localHtmlPath = QDir::currentPath() + "/tiles_viewer/demo.html";
     view->setUrl(QUrl::fromLocalFile(localHtmlPath));
 
@@ -0,0 +1,193 @@
+#include "client.hpp"
+#include "socket_io.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr std::size_t initial_shm_size = 4 * 1024 * 1024;
+
+    ServerRequest makeRequest(RequestType type, std::string const& path)
+    {
+        ServerRequest request;
+        request.type = type;
+        std::strncpy(request.path, path.c_str(), sizeof(request.path) - 1);
+        return request;
+    }
+
+    void setTileOptions(ServerRequest& request, TileOptions const& options)
+    {
+        request.tile_size = options.tile_size;
+        request.overlap = options.overlap;
+        request.format = options.format;
+        request.quality = options.quality;
+    }
+} // namespace
+
+ReaderClient::ReaderClient(std::string socketPath)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_socket < 0 || connect(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        std::cerr << "Error: failed to connect to " << socketPath << ": " << std::strerror(errno) << std::endl;
+        if (m_socket >= 0) close(m_socket);
+        m_socket = -1;
+        return;
+    }
+    if (!attach(initial_shm_size))
+    {
+        close(m_socket);
+        m_socket = -1;
+    }
+}
+
+ReaderClient::~ReaderClient()
+{
+    if (m_shm) munmap(m_shm, m_shm_size);
+    if (m_socket >= 0) close(m_socket);
+}
+
+bool ReaderClient::isConnected() const
+{
+    return m_socket >= 0;
+}
+
+std::optional<ServerResponse> ReaderClient::getInfo(std::string const& path, int series)
+{
+    auto request = makeRequest(RequestType::Info, path);
+    request.series = series;
+    return call(request);
+}
+
+std::span<std::byte const> ReaderClient::readPlane(std::string const& path, int series, int no)
+{
+    auto request = makeRequest(RequestType::Plane, path);
+    request.series = series;
+    request.no = no;
+    return payload(call(request));
+}
+
+bool ReaderClient::readPlaneInto(std::string const& path, int series, int no, std::span<std::byte> dst)
+{
+    auto plane = readPlane(path, series, no);
+    if (plane.empty() || plane.size() > dst.size()) return false;
+    std::memcpy(dst.data(), plane.data(), plane.size());
+    return true;
+}
+
+std::optional<ServerResponse> ReaderClient::getSlideInfo(std::string const& path, int level,
+                                                         TileOptions const& options)
+{
+    auto request = makeRequest(RequestType::Info, path);
+    request.level = level;
+    setTileOptions(request, options);
+    return call(request);
+}
+
+std::span<std::byte const> ReaderClient::getTile(std::string const& path, int level, int col, int row,
+                                                 TileOptions const& options)
+{
+    auto request = makeRequest(RequestType::Tile, path);
+    request.level = level;
+    request.col = col;
+    request.row = row;
+    setTileOptions(request, options);
+    return payload(call(request));
+}
+
+std::string ReaderClient::getDzi(std::string const& path, TileOptions const& options)
+{
+    auto request = makeRequest(RequestType::Dzi, path);
+    setTileOptions(request, options);
+    auto xml = payload(call(request));
+    return {reinterpret_cast<char const*>(xml.data()), xml.size()};
+}
+
+std::optional<ServerResponse> ReaderClient::call(ServerRequest const& request)
+{
+    if (m_socket < 0) return std::nullopt;
+
+    for (auto attempt = 0; attempt < 2; attempt++)
+    {
+        ServerResponse response;
+        if (!writeMessage(m_socket, &request, sizeof(request)) || !readMessage(m_socket, &response, sizeof(response)))
+        {
+            std::cerr << "Error: connection to the reader server lost" << std::endl;
+            close(m_socket);
+            m_socket = -1;
+            return std::nullopt;
+        }
+        if (response.status == Status::BufferTooSmall && attempt == 0 && attach(response.size)) continue;
+        return response;
+    }
+    return std::nullopt;
+}
+
+bool ReaderClient::attach(std::size_t size)
+{
+    // page aligned, with some headroom so slightly larger planes / tiles do not attach again
+    size = std::max(size + size / 4, m_shm_size);
+    size = (size + 4095) / 4096 * 4096;
+
+    static std::atomic<int> counter = 0;
+    auto name = "/bioimread-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+    auto fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        std::cerr << "Error: shm_open failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // only the descriptors keep the segment alive, nothing is left in /dev/shm if either process dies
+    shm_unlink(name.c_str());
+
+    void* shm = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+        shm = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (shm == MAP_FAILED)
+    {
+        std::cerr << "Error: failed to map " << size << " bytes of shared memory: " << std::strerror(errno)
+                  << std::endl;
+        close(fd);
+        return false;
+    }
+
+    auto request = makeRequest(RequestType::Attach, {});
+    request.shm_size = size;
+    ServerResponse response;
+    auto attached = writeMessage(m_socket, &request, sizeof(request), fd) &&
+                    readMessage(m_socket, &response, sizeof(response)) && response.status == Status::Ok;
+    close(fd);
+    // the server maps `size` bytes of a segment it saw as `response.size` bytes
+    attached &= response.size >= size;
+    if (!attached)
+    {
+        std::cerr << "Error: the reader server failed to attach " << size << " bytes of shared memory" << std::endl;
+        munmap(shm, size);
+        return false;
+    }
+
+    if (m_shm) munmap(m_shm, m_shm_size);
+    m_shm = shm;
+    m_shm_size = size;
+    return true;
+}
+
+std::span<std::byte const> ReaderClient::payload(std::optional<ServerResponse> const& response) const
+{
+    if (!response || response->status != Status::Ok || response->size > m_shm_size) return {};
+    return {static_cast<std::byte const*>(m_shm), response->size};
+}
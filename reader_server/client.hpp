@@ -0,0 +1,56 @@
+#pragma once
+
+#include "protocol.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+
+// deepzoom parameters of the slide, a tile server keeps one generator per combination
+struct TileOptions
+{
+    int tile_size = 254;
+    int overlap = 1;
+    int format = 1; // `DeepZoomGenerator::ImageFormat`, JPG
+    float quality = 0.75f;
+};
+
+// connection to a `plane_server` / `tile_server`, payloads are read from a shared memory segment,
+// one client per thread
+class ReaderClient
+{
+public:
+    explicit ReaderClient(std::string socketPath);
+    ~ReaderClient();
+
+    ReaderClient(ReaderClient const&) = delete;
+    ReaderClient& operator=(ReaderClient const&) = delete;
+
+    bool isConnected() const;
+
+    // plane server
+    std::optional<ServerResponse> getInfo(std::string const& path, int series = 0);
+    // view into the shared memory, valid until the next request, empty on failure
+    std::span<std::byte const> readPlane(std::string const& path, int series, int no);
+    // `dst` needs at least `ServerResponse::plane_size` bytes
+    bool readPlaneInto(std::string const& path, int series, int no, std::span<std::byte> dst);
+
+    // tile server, `level_cols` / `level_rows` are the tiles of deepzoom level `level`
+    std::optional<ServerResponse> getSlideInfo(std::string const& path, int level, TileOptions const& options = {});
+    // encoded tile, view into the shared memory, valid until the next request, empty on failure
+    std::span<std::byte const> getTile(std::string const& path, int level, int col, int row,
+                                       TileOptions const& options = {});
+    std::string getDzi(std::string const& path, TileOptions const& options = {});
+
+private:
+    // retries once with a larger segment if the payload did not fit
+    std::optional<ServerResponse> call(ServerRequest const& request);
+    bool attach(std::size_t size);
+    std::span<std::byte const> payload(std::optional<ServerResponse> const& response) const;
+
+private:
+    int m_socket = -1;
+    void* m_shm = nullptr;
+    std::size_t m_shm_size = 0;
+};
@@ -0,0 +1,129 @@
+#include "client.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+// concurrent clients hammering a plane / tile server for a fixed duration, reports throughput and latency:
+// reader_loadgen <socket> <plane|tile> <path> [clients] [seconds] [level]
+namespace
+{
+    struct Totals
+    {
+        std::atomic<std::uint64_t> requests = 0;
+        std::atomic<std::uint64_t> failures = 0;
+        std::atomic<std::uint64_t> bytes = 0;
+        std::atomic<std::uint64_t> latency_us = 0;
+    };
+
+    // random planes of series 0
+    void loadPlanes(std::string const& socket, std::string const& path, std::chrono::steady_clock::time_point end,
+                    unsigned seed, Totals& totals)
+    {
+        ReaderClient client(socket);
+        auto info = client.getInfo(path);
+        if (!info || info->status != Status::Ok || info->image_count <= 0)
+        {
+            std::cerr << "Error: " << path << " can not be read by the plane server" << std::endl;
+            return;
+        }
+
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> planes(0, info->image_count - 1);
+        while (std::chrono::steady_clock::now() < end)
+        {
+            auto start = std::chrono::steady_clock::now();
+            auto plane = client.readPlane(path, 0, planes(rng));
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            totals.requests++;
+            totals.latency_us += std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+            if (plane.empty())
+                totals.failures++;
+            else
+                totals.bytes += plane.size();
+            if (!client.isConnected()) return;
+        }
+    }
+
+    // random tiles of deepzoom level `level`, the deepest one if negative
+    void loadTiles(std::string const& socket, std::string const& path, int level,
+                   std::chrono::steady_clock::time_point end, unsigned seed, Totals& totals)
+    {
+        ReaderClient client(socket);
+        auto info = client.getSlideInfo(path, 0);
+        if (!info || info->status != Status::Ok || info->level_count <= 0)
+        {
+            std::cerr << "Error: " << path << " can not be read by the tile server" << std::endl;
+            return;
+        }
+        if (level < 0 || level >= info->level_count) level = info->level_count - 1;
+        info = client.getSlideInfo(path, level);
+        if (!info || info->level_cols <= 0 || info->level_rows <= 0) return;
+
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> cols(0, info->level_cols - 1);
+        std::uniform_int_distribution<int> rows(0, info->level_rows - 1);
+        while (std::chrono::steady_clock::now() < end)
+        {
+            auto start = std::chrono::steady_clock::now();
+            auto tile = client.getTile(path, level, cols(rng), rows(rng));
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            totals.requests++;
+            totals.latency_us += std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+            if (tile.empty())
+                totals.failures++;
+            else
+                totals.bytes += tile.size();
+            if (!client.isConnected()) return;
+        }
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <socket> <plane|tile> <path> [clients=4] [seconds=10] [level]"
+                  << std::endl;
+        return 1;
+    }
+    std::string socket = argv[1];
+    std::string mode = argv[2];
+    std::string path = argv[3];
+    auto clients = argc > 4 ? std::max(1, std::stoi(argv[4])) : 4;
+    auto seconds = argc > 5 ? std::max(1, std::stoi(argv[5])) : 10;
+    auto level = argc > 6 ? std::stoi(argv[6]) : -1;
+    if (mode != "plane" && mode != "tile")
+    {
+        std::cerr << "Error: unknown mode " << mode << ", expected plane or tile" << std::endl;
+        return 1;
+    }
+
+    Totals totals;
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < clients; i++)
+    {
+        if (mode == "plane")
+            threads.emplace_back(loadPlanes, socket, path, end, i, std::ref(totals));
+        else
+            threads.emplace_back(loadTiles, socket, path, level, end, i, std::ref(totals));
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    auto requests = totals.requests.load();
+    std::cout << clients << " clients, " << seconds << " s: " << requests << " requests (" << totals.failures
+              << " failed), " << static_cast<double>(requests) / seconds << " req/s, "
+              << static_cast<double>(totals.bytes) / seconds / (1024 * 1024) << " MB/s";
+    if (requests > 0)
+        std::cout << ", mean latency " << static_cast<double>(totals.latency_us) / requests / 1000 << " ms";
+    std::cout << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "server.hpp"
+
+#include "../bfwrapper/jvmwrapper.hpp"
+#include "../bfwrapper/reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// long-lived `bfwrapper` plane server: the JVM stays warm and opened readers are reused across requests,
+// so short-lived clients only pay for the socket round trip and a copy into their shared memory
+namespace
+{
+    class PlaneBackend
+    {
+    public:
+        explicit PlaneBackend(std::size_t max_idle): m_max_idle(max_idle) {}
+
+        ServerResponse handle(ServerRequest const& request, std::span<std::byte> payload)
+        {
+            ServerResponse response;
+            if (request.type != RequestType::Info && request.type != RequestType::Plane)
+            {
+                response.status = Status::Unsupported;
+                return response;
+            }
+
+            auto reader = acquire(request.path, request.series);
+            if (!reader)
+            {
+                response.status = Status::Error;
+                return response;
+            }
+
+            response.plane_size = reader->getPlaneSize();
+            if (request.type == RequestType::Info)
+            {
+                response.image_count = reader->getImageCount();
+                response.series_count = reader->getSeriesCount();
+                response.size_x = reader->getSizeX();
+                response.size_y = reader->getSizeY();
+                response.size_z = reader->getSizeZ();
+                response.size_c = reader->getSizeC();
+                response.size_t = reader->getSizeT();
+                response.pixel_type = static_cast<std::int32_t>(reader->getPixelType());
+                response.bytes_per_pixel = reader->getBytesPerPixel();
+                response.rgb_channel_count = reader->getRGBChannelCount();
+            }
+            else if (request.no < 0 || request.no >= reader->getImageCount())
+                response.status = Status::Error;
+            else if (payload.size() < static_cast<std::size_t>(response.plane_size))
+            {
+                response.status = Status::BufferTooSmall;
+                response.size = response.plane_size;
+            }
+            else if (reader->readPlaneInto(request.no, payload.first(response.plane_size)))
+                response.size = response.plane_size;
+            else
+                response.status = Status::Error;
+
+            release(request.path, request.series, std::move(reader));
+            return response;
+        }
+
+    private:
+        struct Idle
+        {
+            std::string path;
+            int series;
+            std::unique_ptr<Reader> reader;
+        };
+
+        // an idle reader of the file, or a newly opened one, used by one request at a time
+        std::unique_ptr<Reader> acquire(std::string const& path, int series)
+        {
+            {
+                std::lock_guard lock(m_mutex);
+                auto it = std::find_if(m_idle.begin(), m_idle.end(),
+                                       [&](Idle const& idle) { return idle.path == path && idle.series == series; });
+                if (it != m_idle.end())
+                {
+                    auto reader = std::move(it->reader);
+                    m_idle.erase(it);
+                    return reader;
+                }
+            }
+
+            // opened outside of the lock, other files keep being served meanwhile
+            if (!std::filesystem::exists(path) && !path.ends_with(".fake")) return nullptr;
+            auto reader = std::make_unique<Reader>();
+            if (!reader->open(path)) return nullptr;
+            if (series < 0 || series >= reader->getSeriesCount()) return nullptr;
+            reader->setSeries(series);
+            return reader;
+        }
+
+        // most recently used first, the least recently used readers are closed beyond `m_max_idle`
+        void release(std::string const& path, int series, std::unique_ptr<Reader> reader)
+        {
+            std::list<Idle> closed;
+            std::lock_guard lock(m_mutex);
+            m_idle.push_front({path, series, std::move(reader)});
+            while (m_idle.size() > m_max_idle)
+                closed.splice(closed.end(), m_idle, std::prev(m_idle.end()));
+        }
+
+    private:
+        std::size_t m_max_idle;
+        std::mutex m_mutex;
+        std::list<Idle> m_idle;
+    };
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string socket_path = argc > 1 ? argv[1] : default_plane_socket;
+    std::size_t max_idle = argc > 2 ? std::stoul(argv[2]) : 2 * std::max(1u, std::thread::hardware_concurrency());
+
+    // created now rather than by the first request
+    if (!JVMWrapper::getInstance())
+    {
+        std::cerr << "Error: failed to create the JVM" << std::endl;
+        return 1;
+    }
+
+    PlaneBackend backend(max_idle);
+    ReaderServer server(socket_path, [&](ServerRequest const& request, std::span<std::byte> payload) {
+        return backend.handle(request, payload);
+    });
+    if (!server.listen()) return 1;
+    std::cout << "plane server listening on " << socket_path << ", keeping up to " << max_idle << " idle readers"
+              << std::endl;
+    server.run();
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+inline constexpr char default_plane_socket[] = "/tmp/bioimread_plane.sock";
+inline constexpr char default_tile_socket[] = "/tmp/bioimread_tile.sock";
+
+// fixed size messages exchanged over the server's Unix domain socket,
+// pixel / tile payloads go through a shared memory segment owned by the client
+// (passed to the server as a file descriptor with an `Attach` request)
+
+enum class RequestType : std::int32_t
+{
+    Attach = 0, // the client's shared memory fd comes with the request (`SCM_RIGHTS`)
+    Info,       // image / slide geometry, no payload
+    Plane,      // plane `no` of `series`, raw pixels (plane server)
+    Tile,       // deepzoom tile `level/col_row`, encoded bytes (tile server)
+    Dzi,        // deepzoom XML descriptor (tile server)
+};
+
+enum class Status : std::int32_t
+{
+    Ok = 0,
+    Error,          // the file can not be opened / read
+    Unsupported,    // request type not handled by this server
+    BufferTooSmall, // `ServerResponse::size` holds the payload size, attach a larger segment and retry
+    NoBuffer,       // no shared memory attached yet
+};
+
+struct ServerRequest
+{
+    RequestType type = RequestType::Info;
+    std::int32_t series = 0;
+    std::int32_t no = 0;
+    // deepzoom
+    std::int32_t level = 0;
+    std::int32_t col = 0;
+    std::int32_t row = 0;
+    std::int32_t tile_size = 254;
+    std::int32_t overlap = 1;
+    std::int32_t format = 1; // `DeepZoomGenerator::ImageFormat`
+    float quality = 0.75f;
+    std::uint64_t shm_size = 0; // `Attach` only
+    char path[4096]{};
+};
+
+struct ServerResponse
+{
+    Status status = Status::Ok;
+    // payload bytes written at the start of the shared memory, for `Attach` the size of the received segment
+    std::uint64_t size = 0;
+    // `Info`, plane server
+    std::int32_t image_count = 0;
+    std::int32_t series_count = 0;
+    std::int32_t size_x = 0;
+    std::int32_t size_y = 0;
+    std::int32_t size_z = 0;
+    std::int32_t size_c = 0;
+    std::int32_t size_t = 0;
+    std::int32_t pixel_type = 0;
+    std::int32_t bytes_per_pixel = 0;
+    std::int32_t rgb_channel_count = 0;
+    std::int32_t plane_size = 0;
+    // `Info`, tile server (`size_x`, `size_y` are the full resolution dimensions)
+    std::int32_t level_count = 0;
+    std::int32_t tile_count = 0;
+    std::int32_t level_cols = 0; // tiles of `ServerRequest::level`
+    std::int32_t level_rows = 0;
+};
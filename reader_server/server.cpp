@@ -0,0 +1,209 @@
+#include "server.hpp"
+#include "socket_io.hpp"
+
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    volatile std::sig_atomic_t signalled = 0;
+
+    void onSignal(int)
+    {
+        signalled = 1;
+    }
+
+    // the client's shared memory segment, mapped for the lifetime of the connection or until the next `Attach`
+    struct Mapping
+    {
+        void* data = nullptr;
+        std::size_t size = 0;
+
+        ~Mapping() { reset(); }
+
+        bool map(int fd, std::size_t size_)
+        {
+            reset();
+            auto* ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (ptr == MAP_FAILED) return false;
+            data = ptr;
+            size = size_;
+            return true;
+        }
+
+        void reset()
+        {
+            if (data) munmap(data, size);
+            data = nullptr;
+            size = 0;
+        }
+    };
+} // namespace
+
+ReaderServer::ReaderServer(std::string socketPath, Handler handler)
+    : m_socket_path(std::move(socketPath)), m_handler(std::move(handler))
+{
+}
+
+ReaderServer::~ReaderServer()
+{
+    stop();
+    if (m_listen_fd >= 0)
+    {
+        close(m_listen_fd);
+        unlink(m_socket_path.c_str());
+    }
+}
+
+bool ReaderServer::listen()
+{
+    // a client disconnecting mid-response must not kill the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (m_socket_path.size() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "Error: socket path is too long: " << m_socket_path << std::endl;
+        return false;
+    }
+    std::strncpy(addr.sun_path, m_socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    m_listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listen_fd < 0)
+    {
+        std::cerr << "Error: failed to create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // left behind by a server that was killed
+    unlink(m_socket_path.c_str());
+    if (bind(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(m_listen_fd, 64) < 0)
+    {
+        std::cerr << "Error: failed to listen on " << m_socket_path << ": " << std::strerror(errno) << std::endl;
+        close(m_listen_fd);
+        m_listen_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+void ReaderServer::run()
+{
+    struct sigaction action{};
+    action.sa_handler = onSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    while (!m_stop && !signalled && m_listen_fd >= 0)
+    {
+        // wakes up regularly to notice `stop` and to join finished connections
+        pollfd pfd{m_listen_fd, POLLIN, 0};
+        auto ready = poll(&pfd, 1, 200);
+        reapFinished();
+        if (ready <= 0) continue;
+
+        auto client = accept(m_listen_fd, nullptr, nullptr);
+        if (client < 0) continue;
+
+        std::lock_guard lock(m_mutex);
+        if (m_stop)
+        {
+            close(client);
+            break;
+        }
+        m_clients.push_back(client);
+        auto self = m_connections.emplace(m_connections.end());
+        *self = std::thread(&ReaderServer::serve, this, client, self);
+    }
+    stop();
+}
+
+void ReaderServer::stop()
+{
+    std::list<std::thread> connections;
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+        for (auto client : m_clients)
+            shutdown(client, SHUT_RDWR);
+        connections = std::move(m_connections);
+        m_finished.clear();
+    }
+    for (auto& connection : connections)
+        if (connection.joinable()) connection.join();
+}
+
+void ReaderServer::serve(int client, std::list<std::thread>::iterator self)
+{
+    Mapping shm;
+    while (!m_stop)
+    {
+        ServerRequest request;
+        int fd = -1;
+        if (!readMessage(client, &request, sizeof(request), &fd)) break;
+        request.path[sizeof(request.path) - 1] = '\0';
+
+        ServerResponse response;
+        if (request.type == RequestType::Attach)
+        {
+            // a size past the end of the segment would SIGBUS the whole server on the first write
+            struct stat st{};
+            auto stated = fd >= 0 && fstat(fd, &st) == 0;
+            if (stated) response.size = static_cast<std::uint64_t>(st.st_size);
+            auto valid = stated && request.shm_size > 0 && request.shm_size <= response.size;
+            response.status = valid && shm.map(fd, request.shm_size) ? Status::Ok : Status::Error;
+            if (fd >= 0) close(fd);
+        }
+        else
+        {
+            if (fd >= 0) close(fd);
+            if (!shm.data)
+                response.status = Status::NoBuffer;
+            else
+            {
+                try
+                {
+                    response = m_handler(request, {static_cast<std::byte*>(shm.data), shm.size});
+                }
+                catch (std::exception const& e)
+                {
+                    std::cerr << "Error: request on " << request.path << " failed: " << e.what() << std::endl;
+                    response = {};
+                    response.status = Status::Error;
+                }
+            }
+        }
+        if (!writeMessage(client, &response, sizeof(response))) break;
+    }
+
+    std::lock_guard lock(m_mutex);
+    close(client);
+    std::erase(m_clients, client);
+    if (!m_stop) m_finished.push_back(self);
+}
+
+void ReaderServer::reapFinished()
+{
+    std::vector<std::thread> finished;
+    {
+        std::lock_guard lock(m_mutex);
+        for (auto it : m_finished)
+        {
+            finished.push_back(std::move(*it));
+            m_connections.erase(it);
+        }
+        m_finished.clear();
+    }
+    for (auto& thread : finished)
+        thread.join();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "protocol.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// accepts clients on a Unix domain socket, one thread per connection,
+// requests are answered by `handler` with the connection's shared memory as payload buffer
+class ReaderServer
+{
+public:
+    // called concurrently from the connection threads
+    using Handler = std::function<ServerResponse(ServerRequest const& request, std::span<std::byte> payload)>;
+
+    ReaderServer(std::string socketPath, Handler handler);
+    ~ReaderServer();
+
+    ReaderServer(ReaderServer const&) = delete;
+    ReaderServer& operator=(ReaderServer const&) = delete;
+
+    // false if the socket can not be bound, a stale socket file is replaced
+    bool listen();
+    // blocks until `stop` or SIGINT / SIGTERM
+    void run();
+    void stop();
+
+private:
+    void serve(int client, std::list<std::thread>::iterator self);
+    void reapFinished();
+
+private:
+    std::string m_socket_path;
+    Handler m_handler;
+    int m_listen_fd = -1;
+    std::atomic<bool> m_stop = false;
+
+    std::mutex m_mutex;
+    std::list<std::thread> m_connections;
+    std::vector<std::list<std::thread>::iterator> m_finished; // joined by the accept loop
+    std::vector<int> m_clients;                               // shut down on `stop` to wake their threads
+};
@@ -0,0 +1,76 @@
+#include "socket_io.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+bool writeMessage(int socket, void const* data, std::size_t size, int pass_fd)
+{
+    auto const* bytes = static_cast<char const*>(data);
+    std::size_t sent = 0;
+    while (sent < size)
+    {
+        iovec iov{const_cast<char*>(bytes + sent), size - sent};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+
+        // the descriptor goes with the first chunk only
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+        if (pass_fd >= 0 && sent == 0)
+        {
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            auto* cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(cmsg), &pass_fd, sizeof(int));
+        }
+
+        auto n = sendmsg(socket, &msg, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool readMessage(int socket, void* data, std::size_t size, int* passed_fd)
+{
+    if (passed_fd) *passed_fd = -1;
+
+    auto* bytes = static_cast<char*>(data);
+    std::size_t received = 0;
+    while (received < size)
+    {
+        iovec iov{bytes + received, size - received};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        auto n = recvmsg(socket, &msg, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        received += static_cast<std::size_t>(n);
+
+        for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+            {
+                int fd;
+                std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+                // only one descriptor is expected per message, drop any other
+                if (passed_fd && *passed_fd < 0)
+                    *passed_fd = fd;
+                else
+                    close(fd);
+            }
+    }
+    return true;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+// blocking send / receive of one whole message on a Unix domain stream socket, retried on `EINTR`,
+// false if the peer closed the connection or on error
+
+// `pass_fd >= 0` is sent along with the message (`SCM_RIGHTS`)
+bool writeMessage(int socket, void const* data, std::size_t size, int pass_fd = -1);
+// `*passed_fd` is set to a received file descriptor, or -1 if none came with the message
+bool readMessage(int socket, void* data, std::size_t size, int* passed_fd = nullptr);
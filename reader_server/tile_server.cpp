@@ -0,0 +1,170 @@
+#include "server.hpp"
+
+#include "../bfwrapper/jvmwrapper.hpp"
+#include "../qpwrapper/deepzoom.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+
+// long-lived deepzoom tile server: slides stay opened (with their tile cache and worker readers) across requests
+namespace
+{
+    class TileBackend
+    {
+    public:
+        explicit TileBackend(std::size_t max_slides): m_max_slides(max_slides) {}
+
+        ServerResponse handle(ServerRequest const& request, std::span<std::byte> payload)
+        {
+            ServerResponse response;
+            if (request.type != RequestType::Info && request.type != RequestType::Tile &&
+                request.type != RequestType::Dzi)
+            {
+                response.status = Status::Unsupported;
+                return response;
+            }
+
+            auto slide = get(request);
+            if (!slide)
+            {
+                response.status = Status::Error;
+                return response;
+            }
+
+            auto tiles = slide->level_tiles();
+            auto valid_level = request.level >= 0 && request.level < slide->level_count();
+            if (request.type == RequestType::Info)
+            {
+                auto [width, height] = slide->level_dimensions().back();
+                response.size_x = width;
+                response.size_y = height;
+                response.level_count = slide->level_count();
+                response.tile_count = slide->tile_count();
+                if (valid_level) std::tie(response.level_cols, response.level_rows) = tiles[request.level];
+                return response;
+            }
+
+            std::vector<unsigned char> bytes;
+            if (request.type == RequestType::Dzi)
+            {
+                auto dzi = slide->get_dzi();
+                bytes.assign(dzi.begin(), dzi.end());
+            }
+            else if (valid_level && request.col >= 0 && request.col < tiles[request.level].first &&
+                     request.row >= 0 && request.row < tiles[request.level].second)
+                // the generator's workers are safe to share between connections
+                bytes = slide->get_tile_async(request.level, request.col, request.row).get();
+
+            if (bytes.empty())
+                response.status = Status::Error;
+            else if (payload.size() < bytes.size())
+            {
+                response.status = Status::BufferTooSmall;
+                response.size = bytes.size();
+            }
+            else
+            {
+                std::memcpy(payload.data(), bytes.data(), bytes.size());
+                response.size = bytes.size();
+            }
+            return response;
+        }
+
+    private:
+        struct Slide
+        {
+            std::string path;
+            int tile_size;
+            int overlap;
+            int format;
+            float quality;
+            std::shared_ptr<DeepZoomGenerator> generator;
+
+            bool matches(ServerRequest const& request) const
+            {
+                return path == request.path && tile_size == request.tile_size && overlap == request.overlap &&
+                       format == request.format && quality == request.quality;
+            }
+        };
+
+        // most recently used first, the least recently used slides are closed beyond `m_max_slides`
+        std::shared_ptr<DeepZoomGenerator> get(ServerRequest const& request)
+        {
+            {
+                std::lock_guard lock(m_mutex);
+                if (auto generator = find(request)) return generator;
+            }
+
+            // `DeepZoomGenerator` has no failure state, a missing file would crash it
+            if (!std::filesystem::exists(request.path) || request.tile_size <= 0 || request.overlap < 0) return nullptr;
+            // opening the slide and starting its workers is slow, the other connections keep being served meanwhile
+            auto format =
+                request.format == 0 ? DeepZoomGenerator::ImageFormat::PNG : DeepZoomGenerator::ImageFormat::JPG;
+            auto generator = std::make_shared<DeepZoomGenerator>(request.path, request.tile_size, request.overlap,
+                                                                 format, request.quality);
+
+            // destroyed after unlocking, closing a slide joins its workers
+            std::optional<Slide> evicted;
+            {
+                std::lock_guard lock(m_mutex);
+                // opened by another connection in the meantime, ours is dropped (outside the lock)
+                if (auto existing = find(request)) return existing;
+                m_slides.push_front(
+                    {request.path, request.tile_size, request.overlap, request.format, request.quality, generator});
+                // requests still reading tiles of an evicted slide keep it alive
+                if (m_slides.size() > m_max_slides)
+                {
+                    evicted = std::move(m_slides.back());
+                    m_slides.pop_back();
+                }
+            }
+            return generator;
+        }
+
+        // moves the slide to the front, `m_mutex` held
+        std::shared_ptr<DeepZoomGenerator> find(ServerRequest const& request)
+        {
+            auto it = std::find_if(m_slides.begin(), m_slides.end(),
+                                   [&](Slide const& slide) { return slide.matches(request); });
+            if (it == m_slides.end()) return nullptr;
+            m_slides.splice(m_slides.begin(), m_slides, it);
+            return it->generator;
+        }
+
+    private:
+        std::size_t m_max_slides;
+        std::mutex m_mutex;
+        std::list<Slide> m_slides;
+    };
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string socket_path = argc > 1 ? argv[1] : default_tile_socket;
+    std::size_t max_slides = argc > 2 ? std::stoul(argv[2]) : 8;
+
+    // created now rather than by the first request
+    if (!JVMWrapper::getInstance())
+    {
+        std::cerr << "Error: failed to create the JVM" << std::endl;
+        return 1;
+    }
+
+    TileBackend backend(max_slides);
+    ReaderServer server(socket_path, [&](ServerRequest const& request, std::span<std::byte> payload) {
+        return backend.handle(request, payload);
+    });
+    if (!server.listen()) return 1;
+    std::cout << "tile server listening on " << socket_path << ", keeping up to " << max_slides << " slides opened"
+              << std::endl;
+    server.run();
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include "display_lut.hpp"
+#include "intensity_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    std::uint8_t toLevel(double v, LutWindow const& window)
+    {
+        auto range = window.max - window.min;
+        switch (window.mapping)
+        {
+        case LutMapping::Gamma:
+        {
+            // the linear levels exactly, the formula below rounds differently on some samples
+            if (window.gamma == 1) return scaleSample(v, window.min, 255. / range);
+            auto t = std::clamp((v - window.min) / range, 0., 1.);
+            return static_cast<std::uint8_t>(std::pow(t, window.gamma) * 255 + 0.5);
+        }
+        case LutMapping::Log:
+        {
+            auto t = std::log1p(std::max(v - window.min, 0.)) / std::log1p(range);
+            return static_cast<std::uint8_t>(std::min(t, 1.) * 255 + 0.5);
+        }
+        default:
+            return scaleSample(v, window.min, 255. / range);
+        }
+    }
+
+    std::uint32_t toFalseColor(double v, LutWindow const& window)
+    {
+        auto d = (window.max - window.min) / 3;
+        auto x = std::clamp(v - window.min, 0., window.max - window.min);
+        auto channel = [&](double from) {
+            return static_cast<std::uint32_t>(std::min((x - from) * 255 / d + 0.5, 255.));
+        };
+        if (x < d)
+            // Black to Red
+            return 0xFF000000 | (channel(0) << 16);
+        if (x < 2 * d)
+        {
+            // Red to White
+            auto tmp = channel(d);
+            return 0xFFFF0000 | (tmp << 8) | tmp;
+        }
+        // White to Blue
+        auto tmp = 0xFF - channel(2 * d);
+        return 0xFF0000FF | (tmp << 16) | (tmp << 8);
+    }
+
+    template <typename T>
+    void build(LutWindow const& window, std::vector<std::uint8_t>& levels, std::vector<std::uint32_t>& colors)
+    {
+        using U = std::make_unsigned_t<T>;
+        constexpr std::size_t size = std::size_t(1) << (sizeof(T) * 8);
+        auto is_color = window.mapping == LutMapping::FalseColor;
+        auto gray_window = window;
+        if (is_color) gray_window.mapping = LutMapping::Linear;
+        levels.resize(size);
+        colors.resize(is_color ? size : 0);
+        for (std::size_t i = 0; i < size; i++)
+        {
+            auto v = static_cast<double>(fromOrdered<T, U>(static_cast<U>(i)));
+            levels[i] = toLevel(v, gray_window);
+            if (is_color) colors[i] = toFalseColor(v, window);
+        }
+    }
+} // namespace
+
+bool DisplayLut::supports(Reader::PixelType type)
+{
+    return type == Reader::PixelType::INT8 || type == Reader::PixelType::UINT8 || type == Reader::PixelType::INT16 ||
+           type == Reader::PixelType::UINT16;
+}
+
+bool DisplayLut::setWindow(Reader::PixelType type, LutWindow const& window)
+{
+    if (m_valid && type == m_type && window == m_window) return true;
+
+    m_type = type;
+    m_window = window;
+    m_valid = supports(type) && window.min < window.max;
+    if (!m_valid) return false;
+    switch (type)
+    {
+    case Reader::PixelType::INT8:
+        build<std::int8_t>(window, m_levels, m_colors);
+        break;
+    case Reader::PixelType::UINT8:
+        build<std::uint8_t>(window, m_levels, m_colors);
+        break;
+    case Reader::PixelType::INT16:
+        build<std::int16_t>(window, m_levels, m_colors);
+        break;
+    default:
+        build<std::uint16_t>(window, m_levels, m_colors);
+        break;
+    }
+    return true;
+}
+
+template <typename T, typename Out>
+void DisplayLut::gather(void const* data, std::size_t count, std::vector<Out> const& table, Out* out) const
+{
+    using U = std::make_unsigned_t<T>;
+    auto* p = static_cast<T const*>(data);
+    auto* lut = table.data();
+    for (std::size_t i = 0; i < count; i++)
+        out[i] = lut[toOrdered<T, U>(p[i])];
+}
+
+void DisplayLut::map(void const* data, std::size_t count, std::uint8_t* out) const
+{
+    if (!m_valid) return;
+    switch (m_type)
+    {
+    case Reader::PixelType::INT8:
+        return gather<std::int8_t>(data, count, m_levels, out);
+    case Reader::PixelType::UINT8:
+        return gather<std::uint8_t>(data, count, m_levels, out);
+    case Reader::PixelType::INT16:
+        return gather<std::int16_t>(data, count, m_levels, out);
+    default:
+        return gather<std::uint16_t>(data, count, m_levels, out);
+    }
+}
+
+void DisplayLut::map(void const* data, std::size_t count, std::uint32_t* out) const
+{
+    if (!m_valid) return;
+    if (!isColor())
+    {
+        // gray levels expanded in place, from the end since the 8 bit levels are narrower
+        auto* levels = reinterpret_cast<std::uint8_t*>(out);
+        map(data, count, levels);
+        for (auto i = count; i-- > 0;)
+            out[i] = 0xFF000000 | (std::uint32_t(levels[i]) * 0x010101);
+        return;
+    }
+    switch (m_type)
+    {
+    case Reader::PixelType::INT8:
+        return gather<std::int8_t>(data, count, m_colors, out);
+    case Reader::PixelType::UINT8:
+        return gather<std::uint8_t>(data, count, m_colors, out);
+    case Reader::PixelType::INT16:
+        return gather<std::int16_t>(data, count, m_colors, out);
+    default:
+        return gather<std::uint16_t>(data, count, m_colors, out);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../bfwrapper/reader.hpp"
+
+// display mapping of 8 / 16 bit samples through lookup tables with one entry per sample value, redisplaying a plane
+// is then a gather instead of a multiply / round / clamp per pixel
+
+enum class LutMapping
+{
+    // `round((v - min) * 255 / (max - min))`, same as `scaleTo8Bit`
+    Linear,
+    // `((v - min) / (max - min)) ^ gamma`
+    Gamma,
+    // `log(1 + v - min) / log(1 + max - min)`
+    Log,
+    // RGB32 black body: black to red, red to white then white to blue over thirds of the window
+    FalseColor
+};
+
+struct LutWindow
+{
+    double min{};
+    double max{};
+    LutMapping mapping{LutMapping::Linear};
+    double gamma{1.};
+
+    bool operator==(LutWindow const&) const = default;
+};
+
+class DisplayLut
+{
+public:
+    // INT8, UINT8, INT16 and UINT16
+    static bool supports(Reader::PixelType type);
+
+    // the table is rebuilt only when `type` or `window` differ from the previous call,
+    // false if the type is not supported or the window is empty (`min >= max`)
+    bool setWindow(Reader::PixelType type, LutWindow const& window);
+    bool isValid() const { return m_valid; }
+    bool isColor() const { return m_window.mapping == LutMapping::FalseColor; }
+
+    // gray levels, `FalseColor` tables give the linear levels
+    void map(void const* data, std::size_t count, std::uint8_t* out) const;
+    // `0xAARRGGBB` colors (`QImage::Format_RGB32`), gray for the gray mappings
+    void map(void const* data, std::size_t count, std::uint32_t* out) const;
+
+private:
+    template <typename T, typename Out>
+    void gather(void const* data, std::size_t count, std::vector<Out> const& table, Out* out) const;
+
+private:
+    Reader::PixelType m_type{Reader::PixelType::BIT};
+    LutWindow m_window{};
+    bool m_valid{false};
+    // indexed by the samples mapped to unsigned (`toOrdered`)
+    std::vector<std::uint8_t> m_levels;
+    std::vector<std::uint32_t> m_colors;
+};
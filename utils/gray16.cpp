@@ -1,32 +1,70 @@
 #include "gray16.hpp"
+#include "display_lut.hpp"
+#include "parallel.hpp"
 
 #include <qDebug>
 
 std::pair<uint16_t, uint16_t> minMax(QImage const& img, bool non_saturated)
 {
-    uint16_t min{0xFFFF}, max{0};
-    auto* ptr = reinterpret_cast<const uint16_t*>(img.constBits());
-    if (non_saturated)
-    {
-        for (auto i = 0; i < img.width() * img.height(); i++)
+    auto width = img.width();
+    auto* in = img.constBits();
+    auto in_stride = img.bytesPerLine();
+    // per block of rows, reduced afterwards
+    auto block_min_max = [&](qsizetype begin, qsizetype end) {
+        uint16_t min{0xFFFF}, max{0};
+        for (auto y = begin; y < end; y++)
         {
-            // non-saturated black
-            if (ptr[i] > 0) min = std::min(ptr[i], min);
-            // non-saturated white
-            if (ptr[i] < 0xFFFF) max = std::max(ptr[i], max);
+            auto* ptr = reinterpret_cast<const uint16_t*>(in + y * in_stride);
+            if (non_saturated)
+            {
+                for (auto i = 0; i < width; i++)
+                {
+                    // non-saturated black
+                    if (ptr[i] > 0) min = std::min(ptr[i], min);
+                    // non-saturated white
+                    if (ptr[i] < 0xFFFF) max = std::max(ptr[i], max);
+                }
+            }
+            else
+            {
+                for (auto i = 0; i < width; i++)
+                {
+                    min = std::min(ptr[i], min);
+                    max = std::max(ptr[i], max);
+                }
+            }
         }
         return std::make_pair(min, max);
-    }
-    else
+    };
+    return parallelReduce(
+        img.height(), std::make_pair(uint16_t{0xFFFF}, uint16_t{0}), block_min_max,
+        [](auto a, auto b) { return std::make_pair(std::min(a.first, b.first), std::max(a.second, b.second)); },
+        rowGrain(width));
+}
+
+namespace
+{
+    // tables rebuilt only when the window changes between calls
+    thread_local DisplayLut display_lut;
+
+    template <typename Out>
+    QImage mapRows(QImage const& img, QImage out)
     {
-        for (auto i = 0; i < img.width() * img.height(); i++)
-        {
-            min = std::min(ptr[i], min);
-            max = std::max(ptr[i], max);
-        }
-        return std::make_pair(min, max);
+        auto width = img.width();
+        auto* out_bits = out.bits();
+        auto* in_bits = img.constBits();
+        auto out_stride = out.bytesPerLine(), in_stride = img.bytesPerLine();
+        auto const& lut = display_lut;
+        parallelFor(
+            img.height(),
+            [&](qsizetype begin, qsizetype end) {
+                for (auto y = begin; y < end; y++)
+                    lut.map(in_bits + y * in_stride, width, reinterpret_cast<Out*>(out_bits + y * out_stride));
+            },
+            rowGrain(width));
+        return out;
     }
-}
+} // namespace
 
 QImage gray16ToGray8(QImage const& img, uint16_t min, uint16_t max)
 {
@@ -41,48 +79,23 @@ QImage gray16ToGray8(QImage const& img, uint16_t min, uint16_t max)
         qCritical() << "invalid min max range";
         return img;
     }
-    auto scale = 255. / (max - min);
-    QImage out(img.width(), img.height(), QImage::Format_Grayscale8);
-    auto* out_p = reinterpret_cast<uint8_t*>(out.bits());
-    auto* in_p = reinterpret_cast<const uint16_t*>(img.constBits());
-    for (auto i = 0; i < img.width() * img.height(); i++)
-        out_p[i] = std::clamp(static_cast<int>(std::round((in_p[i] - min) * scale)), 0, 255);
-    return out;
+    display_lut.setWindow(Reader::PixelType::UINT16, {double(min), double(max)});
+    return mapRows<uint8_t>(img, QImage(img.width(), img.height(), QImage::Format_Grayscale8));
 }
 
 QImage falseColor(QImage const& img, bool useMinMax)
 {
-    QImage out(img.width(), img.height(), QImage::Format_RGB32);
-    auto* out_p = reinterpret_cast<uint32_t*>(out.bits());
-    auto* in_p = reinterpret_cast<const uint16_t*>(img.constBits());
-    uint16_t d = 0x5555;
+    LutWindow window{0, 0xFFFF, LutMapping::FalseColor};
     if (useMinMax)
     {
         auto [min, max] = minMax(img);
-        d = (max - min) / 3.;
+        window.min = min;
+        window.max = max;
     }
-    auto const scale = 255 / d;
-    for (int i = 0; i < img.width() * img.height(); ++i)
+    if (!display_lut.setWindow(Reader::PixelType::UINT16, window))
     {
-        if (in_p[i] < d)
-        {
-            // Black to Red
-            auto tmp = static_cast<uint32_t>(std::round(in_p[i] * scale));
-            out_p[i] = 0xFF000000 | (tmp << 16);
-        }
-        else if (in_p[i] >= d && in_p[i] < 2 * d)
-        {
-            // Red to White
-            auto tmp = static_cast<uint32_t>(std::round((in_p[i] - d) * scale));
-            out_p[i] = 0xFFFF0000 | (tmp << 8) | tmp;
-        }
-        else if (in_p[i] >= 2 * d)
-        {
-            // White to Blue
-            auto tmp = 0xFF - static_cast<uint32_t>(std::round((in_p[i] - 2 * d) * scale));
-            out_p[i] = 0xFF0000FF | (tmp << 16) | (tmp << 8);
-        }
+        qCritical() << "invalid min max range";
+        return QImage();
     }
-
-    return out;
+    return mapRows<uint32_t>(img, QImage(img.width(), img.height(), QImage::Format_RGB32));
 }
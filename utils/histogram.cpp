@@ -0,0 +1,147 @@
+#include "histogram.hpp"
+#include "intensity_kernels.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    // samples per block, large enough to amortize merging the (up to 65536 bins) partial histograms
+    constexpr qsizetype block_grain = qsizetype(1) << 20;
+
+    std::vector<std::uint64_t> merge(std::vector<std::uint64_t> a, std::vector<std::uint64_t> b)
+    {
+        if (a.empty()) return b;
+        for (std::size_t i = 0; i < a.size(); i++)
+            a[i] += b[i];
+        return a;
+    }
+
+    // a histogram per way so that consecutive samples of the same value do not wait on each other's increment,
+    // 32 bit counters are enough for the 2GB planes Bio-Formats can return
+    template <typename T>
+    std::vector<std::uint64_t> countExact(T const* p, std::size_t count)
+    {
+        using U = std::make_unsigned_t<T>;
+        constexpr std::size_t bins = std::size_t(1) << (sizeof(T) * 8);
+        constexpr std::size_t ways = sizeof(T) == 1 ? 4 : 2;
+        std::vector<std::uint32_t> sub(bins * ways);
+        std::size_t i = 0;
+        for (; i + ways <= count; i += ways)
+            for (std::size_t w = 0; w < ways; w++)
+                sub[w * bins + toOrdered<T, U>(p[i + w])]++;
+        for (; i < count; i++)
+            sub[toOrdered<T, U>(p[i])]++;
+
+        std::vector<std::uint64_t> counts(bins);
+        for (std::size_t w = 0; w < ways; w++)
+            for (std::size_t b = 0; b < bins; b++)
+                counts[b] += sub[w * bins + b];
+        return counts;
+    }
+
+    template <typename T>
+    Histogram exactHistogram(void const* data, std::size_t count)
+    {
+        auto* p = static_cast<T const*>(data);
+        Histogram hist;
+        hist.first = static_cast<double>(std::numeric_limits<T>::lowest());
+        hist.last = static_cast<double>(std::numeric_limits<T>::max());
+        hist.counts = parallelReduce(
+            static_cast<qsizetype>(count), std::vector<std::uint64_t>{},
+            [&](qsizetype begin, qsizetype end) { return countExact(p + begin, end - begin); }, merge, block_grain);
+        if (hist.counts.empty()) hist.counts.assign(std::size_t(1) << (sizeof(T) * 8), 0);
+        // saturated black / white
+        hist.counts.front() = 0;
+        hist.counts.back() = 0;
+        for (auto c : hist.counts)
+            hist.total += c;
+        return hist;
+    }
+
+    template <typename T>
+    Histogram binnedHistogram(Reader::PixelType type, void const* data, std::size_t count, std::size_t bins)
+    {
+        auto* p = static_cast<T const*>(data);
+        auto range = parallelReduce(
+            static_cast<qsizetype>(count),
+            IntensityRange{std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()},
+            [&](qsizetype begin, qsizetype end) { return nonSaturatedMinMax(type, p + begin, end - begin); },
+            [](IntensityRange a, IntensityRange b) {
+                return IntensityRange{std::min(a.min, b.min), std::max(a.max, b.max)};
+            },
+            block_grain);
+
+        Histogram hist;
+        hist.exact = false;
+        hist.counts.assign(std::max<std::size_t>(bins, 1), 0);
+        if (range.min > range.max) return hist;
+        hist.first = range.min;
+        hist.last = range.max;
+        hist.bin_width = range.max > range.min ? (range.max - range.min) / hist.counts.size() : 1.;
+        auto inv_width = 1. / hist.bin_width;
+        auto last_bin = hist.counts.size() - 1;
+        hist.counts = parallelReduce(
+            static_cast<qsizetype>(count), std::vector<std::uint64_t>{},
+            [&](qsizetype begin, qsizetype end) {
+                std::vector<std::uint64_t> counts(last_bin + 1);
+                for (auto i = begin; i < end; i++)
+                {
+                    auto v = static_cast<double>(p[i]);
+                    // saturated samples and NaN are outside of the range
+                    if (!(v >= range.min && v <= range.max)) continue;
+                    counts[std::min(static_cast<std::size_t>((v - range.min) * inv_width), last_bin)]++;
+                }
+                return counts;
+            },
+            merge, block_grain);
+        for (auto c : hist.counts)
+            hist.total += c;
+        return hist;
+    }
+} // namespace
+
+IntensityRange Histogram::window(double low_clip, double high_clip) const
+{
+    if (total == 0) return {std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()};
+
+    auto low_target = static_cast<double>(total) * std::clamp(low_clip, 0., 100.) / 100;
+    auto high_target = static_cast<double>(total) * std::clamp(high_clip, 0., 100.) / 100;
+    std::size_t low = 0;
+    for (std::uint64_t acc = 0; low < counts.size() - 1; low++)
+        if ((acc += counts[low]) > low_target) break;
+    auto high = counts.size() - 1;
+    for (std::uint64_t acc = 0; high > 0; high--)
+        if ((acc += counts[high]) > high_target) break;
+    high = std::max(high, low);
+
+    if (exact) return {first + low, first + high};
+    // edges of the bins, the window covers the whole bins it ends in
+    return {first + low * bin_width, std::min(first + (high + 1) * bin_width, last)};
+}
+
+Histogram buildHistogram(Reader::PixelType type, void const* data, std::size_t count, std::size_t bins)
+{
+    switch (type)
+    {
+    case Reader::PixelType::INT8:
+        return exactHistogram<std::int8_t>(data, count);
+    case Reader::PixelType::UINT8:
+        return exactHistogram<std::uint8_t>(data, count);
+    case Reader::PixelType::INT16:
+        return exactHistogram<std::int16_t>(data, count);
+    case Reader::PixelType::UINT16:
+        return exactHistogram<std::uint16_t>(data, count);
+    case Reader::PixelType::INT32:
+        return binnedHistogram<std::int32_t>(type, data, count, bins);
+    case Reader::PixelType::UINT32:
+        return binnedHistogram<std::uint32_t>(type, data, count, bins);
+    case Reader::PixelType::FLOAT:
+        return binnedHistogram<float>(type, data, count, bins);
+    case Reader::PixelType::DOUBLE:
+        return binnedHistogram<double>(type, data, count, bins);
+    default:
+        return {};
+    }
+}
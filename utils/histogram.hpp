@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "intensity.hpp"
+
+// intensity histogram of a single channel plane, saturated samples (see `nonSaturatedMinMax`) and NaN are left out
+struct Histogram
+{
+    // exact histograms (8 / 16 bit) have one bin per value starting at the lowest value of the type,
+    // the others `bins` bins of `bin_width` over the non-saturated [min, max] of the plane
+    bool exact{true};
+    double first{};
+    double last{};
+    double bin_width{1};
+    std::vector<std::uint64_t> counts;
+    std::uint64_t total{};
+
+    // auto-contrast window leaving out the darkest `low_clip` and brightest `high_clip` percent of the samples,
+    // `{max, min}` of double if the plane has no non-saturated sample
+    IntensityRange window(double low_clip, double high_clip) const;
+};
+
+// one counting pass for 8 / 16 bit planes, a (vectorized) min / max pass then `bins` bins for 32 bit / float ones;
+// split in blocks over the shared thread pool, `Reader::PixelType::BIT` is not supported
+Histogram buildHistogram(Reader::PixelType type, void const* data, std::size_t count, std::size_t bins = 4096);
@@ -0,0 +1,140 @@
+#include "intensity.hpp"
+#include "intensity_kernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace
+{
+    template <typename T>
+    IntensityRange minMaxScalar(void const* data, std::size_t count)
+    {
+        auto* p = static_cast<T const*>(data);
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            T min = std::numeric_limits<T>::max(), max = std::numeric_limits<T>::min();
+            for (std::size_t i = 0; i < count; i++)
+            {
+                if (p[i] > std::numeric_limits<T>::min()) min = std::min(p[i], min);
+                if (p[i] < std::numeric_limits<T>::max()) max = std::max(p[i], max);
+            }
+            return {static_cast<double>(min), static_cast<double>(max)};
+        }
+        else
+        {
+            // branchless, the compiler vectorizes it for the baseline instruction set
+            using U = std::make_unsigned_t<T>;
+            U min_candidate = std::numeric_limits<U>::max(), max_candidate = 0;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                auto u = toOrdered<T, U>(p[i]);
+                min_candidate = std::min(min_candidate, static_cast<U>(u - 1));
+                max_candidate = std::max(max_candidate, static_cast<U>(u + 1));
+            }
+            return orderedRange<T, U>(min_candidate, max_candidate);
+        }
+    }
+
+    template <typename T>
+    void scaleScalar(void const* data, std::size_t count, double min, double scale, std::uint8_t* out)
+    {
+        auto* p = static_cast<T const*>(data);
+        for (std::size_t i = 0; i < count; i++)
+            out[i] = scaleSample(p[i], min, scale);
+    }
+
+    bool cpuSupports(std::string_view name)
+    {
+        if (name == "scalar") return true;
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        if (name == "avx2") return __builtin_cpu_supports("avx2");
+        if (name == "sse4.1") return __builtin_cpu_supports("sse4.1");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int info[4];
+        __cpuid(info, 1);
+        auto sse41 = (info[2] & (1 << 19)) != 0;
+        // AVX state enabled by the OS (OSXSAVE + XCR0)
+        auto avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        if (name == "avx2") return avx && (info[1] & (1 << 5));
+        if (name == "sse4.1") return sse41;
+#endif
+        return false;
+    }
+
+    IntensityKernels const* findKernels(std::string_view name)
+    {
+        for (auto* kernels : {avx2IntensityKernels(), sse41IntensityKernels(), scalarIntensityKernels()})
+            if (kernels && kernels->name == name && cpuSupports(name)) return kernels;
+        return nullptr;
+    }
+
+    IntensityKernels const* bestKernels()
+    {
+        if (auto* name = std::getenv("BIOIMREAD_INTENSITY_KERNEL"); name && *name)
+            if (auto* kernels = findKernels(name)) return kernels;
+        for (auto name : {"avx2", "sse4.1"})
+            if (auto* kernels = findKernels(name)) return kernels;
+        return scalarIntensityKernels();
+    }
+
+    std::atomic<IntensityKernels const*> selected = nullptr;
+
+    IntensityKernels const& kernels()
+    {
+        auto* k = selected.load(std::memory_order_acquire);
+        if (!k)
+        {
+            k = bestKernels();
+            selected.store(k, std::memory_order_release);
+        }
+        return *k;
+    }
+} // namespace
+
+IntensityKernels const* scalarIntensityKernels()
+{
+    static IntensityKernels const kernels{
+        "scalar",
+        {minMaxScalar<std::int8_t>, minMaxScalar<std::uint8_t>, minMaxScalar<std::int16_t>, minMaxScalar<std::uint16_t>,
+         minMaxScalar<std::int32_t>, minMaxScalar<std::uint32_t>, minMaxScalar<float>, minMaxScalar<double>, nullptr},
+        {scaleScalar<std::int8_t>, scaleScalar<std::uint8_t>, scaleScalar<std::int16_t>, scaleScalar<std::uint16_t>,
+         scaleScalar<std::int32_t>, scaleScalar<std::uint32_t>, scaleScalar<float>, scaleScalar<double>, nullptr},
+    };
+    return &kernels;
+}
+
+IntensityRange nonSaturatedMinMax(Reader::PixelType type, void const* data, std::size_t count)
+{
+    auto index = static_cast<std::size_t>(type);
+    auto const& k = kernels();
+    if (index >= k.min_max.size() || !k.min_max[index]) return {};
+    return k.min_max[index](data, count);
+}
+
+void scaleTo8Bit(Reader::PixelType type, void const* data, std::size_t count, double min, double scale,
+                 std::uint8_t* out)
+{
+    auto index = static_cast<std::size_t>(type);
+    auto const& k = kernels();
+    if (index >= k.scale.size() || !k.scale[index]) return;
+    k.scale[index](data, count, min, scale, out);
+}
+
+std::string_view intensityKernel()
+{
+    return kernels().name;
+}
+
+bool setIntensityKernel(std::string_view name)
+{
+    auto* k = findKernels(name);
+    if (k) selected.store(k, std::memory_order_release);
+    return k != nullptr;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "../bfwrapper/reader.hpp"
+
+// intensity windowing of single channel planes, vectorized with AVX2 / SSE4.1 when the CPU supports it
+// (picked at runtime) with a scalar fallback, `Reader::PixelType::BIT` is not supported
+
+struct IntensityRange
+{
+    double min{};
+    double max{};
+};
+
+// smallest sample above `std::numeric_limits<T>::min()` (non-saturated black) and largest sample below
+// `std::numeric_limits<T>::max()` (non-saturated white), `{max, min}` of the type if there are none;
+// for FLOAT / DOUBLE this means the smallest positive sample, NaN is ignored
+IntensityRange nonSaturatedMinMax(Reader::PixelType type, void const* data, std::size_t count);
+
+// `out[i] = clamp(round((data[i] - min) * scale), 0, 255)`, NaN maps to 0
+void scaleTo8Bit(Reader::PixelType type, void const* data, std::size_t count, double min, double scale,
+                 std::uint8_t* out);
+
+// "avx2", "sse4.1" or "scalar", the best one supported by the CPU unless `BIOIMREAD_INTENSITY_KERNEL` names another
+std::string_view intensityKernel();
+// forces a kernel, false if it is not available in this build / on this CPU
+bool setIntensityKernel(std::string_view name);
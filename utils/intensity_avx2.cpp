@@ -0,0 +1,235 @@
+#include "intensity_kernels.hpp"
+
+#if defined(__AVX2__)
+#include <algorithm>
+#include <cstring>
+
+#include <immintrin.h>
+
+namespace
+{
+    template <std::size_t Bytes>
+    struct IntOps;
+
+    template <>
+    struct IntOps<1>
+    {
+        static __m256i set1(std::uint8_t v) { return _mm256_set1_epi8(static_cast<char>(v)); }
+        static __m256i add(__m256i a, __m256i b) { return _mm256_add_epi8(a, b); }
+        static __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi8(a, b); }
+        static __m256i min(__m256i a, __m256i b) { return _mm256_min_epu8(a, b); }
+        static __m256i max(__m256i a, __m256i b) { return _mm256_max_epu8(a, b); }
+    };
+
+    template <>
+    struct IntOps<2>
+    {
+        static __m256i set1(std::uint16_t v) { return _mm256_set1_epi16(static_cast<short>(v)); }
+        static __m256i add(__m256i a, __m256i b) { return _mm256_add_epi16(a, b); }
+        static __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi16(a, b); }
+        static __m256i min(__m256i a, __m256i b) { return _mm256_min_epu16(a, b); }
+        static __m256i max(__m256i a, __m256i b) { return _mm256_max_epu16(a, b); }
+    };
+
+    template <>
+    struct IntOps<4>
+    {
+        static __m256i set1(std::uint32_t v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+        static __m256i add(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+        static __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi32(a, b); }
+        static __m256i min(__m256i a, __m256i b) { return _mm256_min_epu32(a, b); }
+        static __m256i max(__m256i a, __m256i b) { return _mm256_max_epu32(a, b); }
+    };
+
+    template <typename T>
+    IntensityRange minMaxInt(void const* data, std::size_t count)
+    {
+        using U = std::make_unsigned_t<T>;
+        using Ops = IntOps<sizeof(T)>;
+        constexpr std::size_t step = 32 / sizeof(T);
+        auto* p = static_cast<T const*>(data);
+
+        // the sign bit flip of `toOrdered`, adding or xor-ing it is the same
+        auto const bias = Ops::set1(toOrdered<T, U>(0));
+        auto const one = Ops::set1(1);
+        auto min_v = Ops::set1(std::numeric_limits<U>::max());
+        auto max_v = _mm256_setzero_si256();
+        std::size_t i = 0;
+        for (; i + step <= count; i += step)
+        {
+            auto u = Ops::add(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + i)), bias);
+            min_v = Ops::min(min_v, Ops::sub(u, one));
+            max_v = Ops::max(max_v, Ops::add(u, one));
+        }
+
+        U mins[step], maxs[step];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(mins), min_v);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(maxs), max_v);
+        U min_candidate = *std::min_element(mins, mins + step), max_candidate = *std::max_element(maxs, maxs + step);
+        for (; i < count; i++)
+        {
+            auto u = toOrdered<T, U>(p[i]);
+            min_candidate = std::min(min_candidate, static_cast<U>(u - 1));
+            max_candidate = std::max(max_candidate, static_cast<U>(u + 1));
+        }
+        return orderedRange<T, U>(min_candidate, max_candidate);
+    }
+
+    template <typename T>
+    struct FloatOps;
+
+    template <>
+    struct FloatOps<float>
+    {
+        using V = __m256;
+        static V load(float const* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+        static V set1(float v) { return _mm256_set1_ps(v); }
+        // ordered compares, false for NaN
+        static V gt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static V lt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static V blend(V a, V b, V mask) { return _mm256_blendv_ps(a, b, mask); }
+        static V min(V a, V b) { return _mm256_min_ps(a, b); }
+        static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    };
+
+    template <>
+    struct FloatOps<double>
+    {
+        using V = __m256d;
+        static V load(double const* p) { return _mm256_loadu_pd(p); }
+        static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+        static V set1(double v) { return _mm256_set1_pd(v); }
+        static V gt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+        static V lt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+        static V blend(V a, V b, V mask) { return _mm256_blendv_pd(a, b, mask); }
+        static V min(V a, V b) { return _mm256_min_pd(a, b); }
+        static V max(V a, V b) { return _mm256_max_pd(a, b); }
+    };
+
+    template <typename T>
+    IntensityRange minMaxFloat(void const* data, std::size_t count)
+    {
+        using Ops = FloatOps<T>;
+        constexpr std::size_t step = 32 / sizeof(T);
+        auto* p = static_cast<T const*>(data);
+
+        // samples that fail the bound take the reduction's initial value
+        auto const lo = Ops::set1(std::numeric_limits<T>::min()), hi = Ops::set1(std::numeric_limits<T>::max());
+        auto min_v = hi, max_v = lo;
+        std::size_t i = 0;
+        for (; i + step <= count; i += step)
+        {
+            auto v = Ops::load(p + i);
+            min_v = Ops::min(min_v, Ops::blend(hi, v, Ops::gt(v, lo)));
+            max_v = Ops::max(max_v, Ops::blend(lo, v, Ops::lt(v, hi)));
+        }
+
+        T mins[step], maxs[step];
+        Ops::store(mins, min_v);
+        Ops::store(maxs, max_v);
+        T min = *std::min_element(mins, mins + step), max = *std::max_element(maxs, maxs + step);
+        for (; i < count; i++)
+        {
+            if (p[i] > std::numeric_limits<T>::min()) min = std::min(p[i], min);
+            if (p[i] < std::numeric_limits<T>::max()) max = std::max(p[i], max);
+        }
+        return {static_cast<double>(min), static_cast<double>(max)};
+    }
+
+    // 8 samples of up to 16 bits widened to int32
+    template <typename T>
+    __m256i load8(T const* p)
+    {
+        if constexpr (std::is_same_v<T, std::int8_t>)
+            return _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(p)));
+        else if constexpr (std::is_same_v<T, std::uint8_t>)
+            return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(p)));
+        else if constexpr (std::is_same_v<T, std::int16_t>)
+            return _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)));
+        else
+            return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)));
+    }
+
+    // `round((v - min) * scale)` clamped to [0, 255] for 4 samples, as `scaleSample`
+    __m128i scale4(__m256d v, __m256d min_v, __m256d scale_v)
+    {
+        v = _mm256_mul_pd(_mm256_sub_pd(v, min_v), scale_v);
+        // `max` returns its second operand for NaN
+        v = _mm256_min_pd(_mm256_max_pd(v, _mm256_setzero_pd()), _mm256_set1_pd(255.));
+        return _mm256_cvttpd_epi32(_mm256_add_pd(v, _mm256_set1_pd(0.5)));
+    }
+
+    // up to 16 bits, computed in double like the scalar kernel (float rounds exact halves differently),
+    // 8 samples per iteration
+    template <typename T>
+    void scaleSmall(void const* data, std::size_t count, double min, double scale, std::uint8_t* out)
+    {
+        auto* p = static_cast<T const*>(data);
+        auto const min_v = _mm256_set1_pd(min), scale_v = _mm256_set1_pd(scale);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            auto v = load8(p + i);
+            auto lo = scale4(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)), min_v, scale_v);
+            auto hi = scale4(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), min_v, scale_v);
+            auto w = _mm_packus_epi32(lo, hi);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(w, w));
+        }
+        for (; i < count; i++)
+            out[i] = scaleSample(p[i], min, scale);
+    }
+
+    // 4 samples of 32 / 64 bits as double
+    template <typename T>
+    __m256d load4(T const* p)
+    {
+        if constexpr (std::is_same_v<T, std::int32_t>)
+            return _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)));
+        else if constexpr (std::is_same_v<T, std::uint32_t>)
+        {
+            // no unsigned conversion before AVX-512, convert `v - 2^31` and add it back
+            auto v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)), _mm_set1_epi32(INT32_MIN));
+            return _mm256_add_pd(_mm256_cvtepi32_pd(v), _mm256_set1_pd(2147483648.));
+        }
+        else if constexpr (std::is_same_v<T, float>)
+            return _mm256_cvtps_pd(_mm_loadu_ps(p));
+        else
+            return _mm256_loadu_pd(p);
+    }
+
+    template <typename T>
+    void scaleLarge(void const* data, std::size_t count, double min, double scale, std::uint8_t* out)
+    {
+        auto* p = static_cast<T const*>(data);
+        auto const min_v = _mm256_set1_pd(min), scale_v = _mm256_set1_pd(scale);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            auto q = scale4(load4(p + i), min_v, scale_v);
+            auto w = _mm_packus_epi32(q, q);
+            auto bytes = _mm_cvtsi128_si32(_mm_packus_epi16(w, w));
+            std::memcpy(out + i, &bytes, 4);
+        }
+        for (; i < count; i++)
+            out[i] = scaleSample(p[i], min, scale);
+    }
+} // namespace
+
+IntensityKernels const* avx2IntensityKernels()
+{
+    static IntensityKernels const kernels{
+        "avx2",
+        {minMaxInt<std::int8_t>, minMaxInt<std::uint8_t>, minMaxInt<std::int16_t>, minMaxInt<std::uint16_t>,
+         minMaxInt<std::int32_t>, minMaxInt<std::uint32_t>, minMaxFloat<float>, minMaxFloat<double>, nullptr},
+        {scaleSmall<std::int8_t>, scaleSmall<std::uint8_t>, scaleSmall<std::int16_t>, scaleSmall<std::uint16_t>,
+         scaleLarge<std::int32_t>, scaleLarge<std::uint32_t>, scaleLarge<float>, scaleLarge<double>, nullptr},
+    };
+    return &kernels;
+}
+#else
+IntensityKernels const* avx2IntensityKernels()
+{
+    return nullptr;
+}
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+
+// internal to the intensity kernels, see intensity.hpp
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+#include "intensity.hpp"
+
+struct IntensityKernels
+{
+    using MinMax = IntensityRange (*)(void const* data, std::size_t count);
+    using Scale = void (*)(void const* data, std::size_t count, double min, double scale, std::uint8_t* out);
+
+    std::string_view name;
+    // indexed by `Reader::PixelType`, null for BIT
+    std::array<MinMax, 9> min_max{};
+    std::array<Scale, 9> scale{};
+};
+
+IntensityKernels const* scalarIntensityKernels();
+// null when the translation unit was built without the instruction set (non x86 targets)
+IntensityKernels const* sse41IntensityKernels();
+IntensityKernels const* avx2IntensityKernels();
+
+// order preserving mapping of integer samples to unsigned ones, the min / max kernels search
+// `u - 1` / `u + 1` (wrapping) so that the saturated values drop out without a compare
+template <typename T, typename U>
+constexpr U toOrdered(T v)
+{
+    constexpr U bias = std::is_signed_v<T> ? U(U(1) << (sizeof(U) * 8 - 1)) : U(0);
+    return static_cast<U>(static_cast<U>(v) ^ bias);
+}
+
+template <typename T, typename U>
+constexpr T fromOrdered(U v)
+{
+    constexpr U bias = std::is_signed_v<T> ? U(U(1) << (sizeof(U) * 8 - 1)) : U(0);
+    return static_cast<T>(static_cast<U>(v ^ bias));
+}
+
+// `min_candidate` / `max_candidate` are the reductions of `u - 1` / `u + 1` over all samples
+template <typename T, typename U>
+IntensityRange orderedRange(U min_candidate, U max_candidate)
+{
+    IntensityRange range;
+    range.min = min_candidate == std::numeric_limits<U>::max()
+                    ? static_cast<double>(std::numeric_limits<T>::max())
+                    : static_cast<double>(fromOrdered<T, U>(static_cast<U>(min_candidate + 1)));
+    range.max = max_candidate == 0 ? static_cast<double>(std::numeric_limits<T>::min())
+                                   : static_cast<double>(fromOrdered<T, U>(static_cast<U>(max_candidate - 1)));
+    return range;
+}
+
+// `std::round((v - min) * scale)` clamped to [0, 255], NaN maps to 0
+template <typename T>
+inline std::uint8_t scaleSample(T v, double min, double scale)
+{
+    auto s = (static_cast<double>(v) - min) * scale;
+    // `s + 0.5` truncated is `std::round` for the non-negative values left after clamping
+    return s > 0 ? (s < 255 ? static_cast<std::uint8_t>(s + 0.5) : 255) : 0;
+}
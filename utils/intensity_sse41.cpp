@@ -0,0 +1,236 @@
+#include "intensity_kernels.hpp"
+
+#if defined(__SSE4_1__) || defined(__AVX__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#include <algorithm>
+#include <cstring>
+
+#include <smmintrin.h>
+
+// same kernels as intensity_avx2.cpp on 128 bit registers
+namespace
+{
+    template <std::size_t Bytes>
+    struct IntOps;
+
+    template <>
+    struct IntOps<1>
+    {
+        static __m128i set1(std::uint8_t v) { return _mm_set1_epi8(static_cast<char>(v)); }
+        static __m128i add(__m128i a, __m128i b) { return _mm_add_epi8(a, b); }
+        static __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi8(a, b); }
+        static __m128i min(__m128i a, __m128i b) { return _mm_min_epu8(a, b); }
+        static __m128i max(__m128i a, __m128i b) { return _mm_max_epu8(a, b); }
+    };
+
+    template <>
+    struct IntOps<2>
+    {
+        static __m128i set1(std::uint16_t v) { return _mm_set1_epi16(static_cast<short>(v)); }
+        static __m128i add(__m128i a, __m128i b) { return _mm_add_epi16(a, b); }
+        static __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi16(a, b); }
+        static __m128i min(__m128i a, __m128i b) { return _mm_min_epu16(a, b); }
+        static __m128i max(__m128i a, __m128i b) { return _mm_max_epu16(a, b); }
+    };
+
+    template <>
+    struct IntOps<4>
+    {
+        static __m128i set1(std::uint32_t v) { return _mm_set1_epi32(static_cast<int>(v)); }
+        static __m128i add(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+        static __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi32(a, b); }
+        static __m128i min(__m128i a, __m128i b) { return _mm_min_epu32(a, b); }
+        static __m128i max(__m128i a, __m128i b) { return _mm_max_epu32(a, b); }
+    };
+
+    template <typename T>
+    IntensityRange minMaxInt(void const* data, std::size_t count)
+    {
+        using U = std::make_unsigned_t<T>;
+        using Ops = IntOps<sizeof(T)>;
+        constexpr std::size_t step = 16 / sizeof(T);
+        auto* p = static_cast<T const*>(data);
+
+        auto const bias = Ops::set1(toOrdered<T, U>(0));
+        auto const one = Ops::set1(1);
+        auto min_v = Ops::set1(std::numeric_limits<U>::max());
+        auto max_v = _mm_setzero_si128();
+        std::size_t i = 0;
+        for (; i + step <= count; i += step)
+        {
+            auto u = Ops::add(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i)), bias);
+            min_v = Ops::min(min_v, Ops::sub(u, one));
+            max_v = Ops::max(max_v, Ops::add(u, one));
+        }
+
+        U mins[step], maxs[step];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(mins), min_v);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(maxs), max_v);
+        U min_candidate = *std::min_element(mins, mins + step), max_candidate = *std::max_element(maxs, maxs + step);
+        for (; i < count; i++)
+        {
+            auto u = toOrdered<T, U>(p[i]);
+            min_candidate = std::min(min_candidate, static_cast<U>(u - 1));
+            max_candidate = std::max(max_candidate, static_cast<U>(u + 1));
+        }
+        return orderedRange<T, U>(min_candidate, max_candidate);
+    }
+
+    template <typename T>
+    struct FloatOps;
+
+    template <>
+    struct FloatOps<float>
+    {
+        using V = __m128;
+        static V load(float const* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+        static V set1(float v) { return _mm_set1_ps(v); }
+        static V gt(V a, V b) { return _mm_cmpgt_ps(a, b); }
+        static V lt(V a, V b) { return _mm_cmplt_ps(a, b); }
+        static V blend(V a, V b, V mask) { return _mm_blendv_ps(a, b, mask); }
+        static V min(V a, V b) { return _mm_min_ps(a, b); }
+        static V max(V a, V b) { return _mm_max_ps(a, b); }
+    };
+
+    template <>
+    struct FloatOps<double>
+    {
+        using V = __m128d;
+        static V load(double const* p) { return _mm_loadu_pd(p); }
+        static void store(double* p, V v) { _mm_storeu_pd(p, v); }
+        static V set1(double v) { return _mm_set1_pd(v); }
+        static V gt(V a, V b) { return _mm_cmpgt_pd(a, b); }
+        static V lt(V a, V b) { return _mm_cmplt_pd(a, b); }
+        static V blend(V a, V b, V mask) { return _mm_blendv_pd(a, b, mask); }
+        static V min(V a, V b) { return _mm_min_pd(a, b); }
+        static V max(V a, V b) { return _mm_max_pd(a, b); }
+    };
+
+    template <typename T>
+    IntensityRange minMaxFloat(void const* data, std::size_t count)
+    {
+        using Ops = FloatOps<T>;
+        constexpr std::size_t step = 16 / sizeof(T);
+        auto* p = static_cast<T const*>(data);
+
+        auto const lo = Ops::set1(std::numeric_limits<T>::min()), hi = Ops::set1(std::numeric_limits<T>::max());
+        auto min_v = hi, max_v = lo;
+        std::size_t i = 0;
+        for (; i + step <= count; i += step)
+        {
+            auto v = Ops::load(p + i);
+            min_v = Ops::min(min_v, Ops::blend(hi, v, Ops::gt(v, lo)));
+            max_v = Ops::max(max_v, Ops::blend(lo, v, Ops::lt(v, hi)));
+        }
+
+        T mins[step], maxs[step];
+        Ops::store(mins, min_v);
+        Ops::store(maxs, max_v);
+        T min = *std::min_element(mins, mins + step), max = *std::max_element(maxs, maxs + step);
+        for (; i < count; i++)
+        {
+            if (p[i] > std::numeric_limits<T>::min()) min = std::min(p[i], min);
+            if (p[i] < std::numeric_limits<T>::max()) max = std::max(p[i], max);
+        }
+        return {static_cast<double>(min), static_cast<double>(max)};
+    }
+
+    // 4 samples of up to 16 bits widened to int32
+    template <typename T>
+    __m128i load4(T const* p)
+    {
+        if constexpr (sizeof(T) == 1)
+        {
+            int bytes;
+            std::memcpy(&bytes, p, 4);
+            if constexpr (std::is_signed_v<T>)
+                return _mm_cvtepi8_epi32(_mm_cvtsi32_si128(bytes));
+            else
+                return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes));
+        }
+        else if constexpr (std::is_signed_v<T>)
+            return _mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(p)));
+        else
+            return _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(p)));
+    }
+
+    // `round((v - min) * scale)` clamped to [0, 255] for 2 samples, as `scaleSample`
+    __m128i scale2(__m128d v, __m128d min_v, __m128d scale_v)
+    {
+        v = _mm_mul_pd(_mm_sub_pd(v, min_v), scale_v);
+        v = _mm_min_pd(_mm_max_pd(v, _mm_setzero_pd()), _mm_set1_pd(255.));
+        return _mm_cvttpd_epi32(_mm_add_pd(v, _mm_set1_pd(0.5)));
+    }
+
+    template <typename T>
+    void scaleSmall(void const* data, std::size_t count, double min, double scale, std::uint8_t* out)
+    {
+        auto* p = static_cast<T const*>(data);
+        auto const min_v = _mm_set1_pd(min), scale_v = _mm_set1_pd(scale);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            auto v = load4(p + i);
+            auto lo = scale2(_mm_cvtepi32_pd(v), min_v, scale_v);
+            auto hi = scale2(_mm_cvtepi32_pd(_mm_unpackhi_epi64(v, v)), min_v, scale_v);
+            auto q = _mm_unpacklo_epi64(lo, hi);
+            auto w = _mm_packus_epi32(q, q);
+            auto bytes = _mm_cvtsi128_si32(_mm_packus_epi16(w, w));
+            std::memcpy(out + i, &bytes, 4);
+        }
+        for (; i < count; i++)
+            out[i] = scaleSample(p[i], min, scale);
+    }
+
+    // 2 samples of 32 / 64 bits as double
+    template <typename T>
+    __m128d load2(T const* p)
+    {
+        if constexpr (std::is_same_v<T, std::int32_t>)
+            return _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(p)));
+        else if constexpr (std::is_same_v<T, std::uint32_t>)
+        {
+            auto v = _mm_xor_si128(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(p)), _mm_set1_epi32(INT32_MIN));
+            return _mm_add_pd(_mm_cvtepi32_pd(v), _mm_set1_pd(2147483648.));
+        }
+        else if constexpr (std::is_same_v<T, float>)
+            return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(p))));
+        else
+            return _mm_loadu_pd(p);
+    }
+
+    template <typename T>
+    void scaleLarge(void const* data, std::size_t count, double min, double scale, std::uint8_t* out)
+    {
+        auto* p = static_cast<T const*>(data);
+        auto const min_v = _mm_set1_pd(min), scale_v = _mm_set1_pd(scale);
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            auto q = scale2(load2(p + i), min_v, scale_v);
+            auto w = _mm_packus_epi32(q, q);
+            auto bytes = static_cast<std::uint16_t>(_mm_cvtsi128_si32(_mm_packus_epi16(w, w)));
+            std::memcpy(out + i, &bytes, 2);
+        }
+        for (; i < count; i++)
+            out[i] = scaleSample(p[i], min, scale);
+    }
+} // namespace
+
+IntensityKernels const* sse41IntensityKernels()
+{
+    static IntensityKernels const kernels{
+        "sse4.1",
+        {minMaxInt<std::int8_t>, minMaxInt<std::uint8_t>, minMaxInt<std::int16_t>, minMaxInt<std::uint16_t>,
+         minMaxInt<std::int32_t>, minMaxInt<std::uint32_t>, minMaxFloat<float>, minMaxFloat<double>, nullptr},
+        {scaleSmall<std::int8_t>, scaleSmall<std::uint8_t>, scaleSmall<std::int16_t>, scaleSmall<std::uint16_t>,
+         scaleLarge<std::int32_t>, scaleLarge<std::uint32_t>, scaleLarge<float>, scaleLarge<double>, nullptr},
+    };
+    return &kernels;
+}
+#else
+IntensityKernels const* sse41IntensityKernels()
+{
+    return nullptr;
+}
+#endif
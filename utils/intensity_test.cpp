@@ -0,0 +1,294 @@
+#include "display_lut.hpp"
+#include "intensity.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// checks the intensity kernels against the former `plane2qimg.cpp` templates and times them, then times the
+// 16 bit lookup tables against them (and checks their gamma / log / false color tables) and the row parallel
+// windowing of `plane2qimg.cpp` with 1..N threads: intensity_test [width] [height]
+
+namespace
+{
+    // former `minMax<T>` / `toIndexed8<T>` passes of plane2qimg.cpp
+    template <typename T>
+    std::pair<T, T> legacyMinMax(char* bytes, std::size_t length)
+    {
+        T min = std::numeric_limits<T>::max(), max = std::numeric_limits<T>::min();
+        auto* ptr = reinterpret_cast<T*>(bytes);
+        for (std::size_t i = 0; i < length; i++)
+        {
+            if (ptr[i] > std::numeric_limits<T>::min()) min = std::min(ptr[i], min);
+            if (ptr[i] < std::numeric_limits<T>::max()) max = std::max(ptr[i], max);
+        }
+        return std::make_pair(min, max);
+    }
+
+    template <typename T>
+    void legacyScale(char* bytes, std::size_t length, T min, double scale, std::uint8_t* out_p)
+    {
+        auto* in_p = reinterpret_cast<T*>(bytes);
+        for (std::size_t i = 0; i < length; i++)
+            out_p[i] = std::clamp(static_cast<int>(std::round((in_p[i] - min) * scale)), 0, 255);
+    }
+
+    // `legacyScale` with `in - min` in double, the legacy one wraps around for UINT32 samples below `min`
+    template <typename T>
+    void referenceScale(T const* in_p, std::size_t length, double min, double scale, std::uint8_t* out_p)
+    {
+        for (std::size_t i = 0; i < length; i++)
+        {
+            auto v = std::round((static_cast<double>(in_p[i]) - min) * scale);
+            out_p[i] = std::isnan(v) ? 0 : static_cast<std::uint8_t>(std::clamp(v, 0., 255.));
+        }
+    }
+
+    // keeps the timed passes from being optimized away
+    volatile double sink = 0;
+
+    template <typename F>
+    double bestOf(int runs, F&& f)
+    {
+        auto best = std::numeric_limits<double>::max();
+        for (auto r = 0; r < runs; r++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            f();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    // noise in the lower half of the range with saturated black / white samples sprinkled in (and NaN for floats)
+    template <typename T>
+    std::vector<T> makePlane(std::size_t length)
+    {
+        std::mt19937 rng(42);
+        std::vector<T> plane(length);
+        using Dist = std::conditional_t<std::is_floating_point_v<T>, std::uniform_real_distribution<double>,
+                                        std::uniform_int_distribution<long long>>;
+        auto lo = std::is_floating_point_v<T> ? -100. : static_cast<double>(std::numeric_limits<T>::lowest()) / 2;
+        auto hi = std::is_floating_point_v<T> ? 1000. : static_cast<double>(std::numeric_limits<T>::max()) / 2;
+        Dist dist(static_cast<typename Dist::result_type>(lo), static_cast<typename Dist::result_type>(hi));
+        for (auto& v : plane)
+            v = static_cast<T>(dist(rng));
+        for (std::size_t i = 0; i < length; i += 97)
+            plane[i] = std::numeric_limits<T>::min();
+        for (std::size_t i = 13; i < length; i += 89)
+            plane[i] = std::numeric_limits<T>::max();
+        if constexpr (std::is_floating_point_v<T>)
+            for (std::size_t i = 7; i < length; i += 101)
+                plane[i] = std::numeric_limits<T>::quiet_NaN();
+        return plane;
+    }
+
+    template <typename T>
+    bool run(Reader::PixelType type, char const* name, std::size_t length)
+    {
+        constexpr int runs = 5;
+        auto plane = makePlane<T>(length);
+        auto* bytes = reinterpret_cast<char*>(plane.data());
+        std::vector<std::uint8_t> expected(length), out(length);
+
+        auto [legacy_min, legacy_max] = legacyMinMax<T>(bytes, length);
+        auto scale = 255. / (static_cast<double>(legacy_max) - static_cast<double>(legacy_min));
+        referenceScale(plane.data(), length, legacy_min, scale, expected.data());
+        auto legacy_min_max_ms = bestOf(runs, [&] { sink = sink + legacyMinMax<T>(bytes, length).first; });
+        auto legacy_scale_ms = bestOf(runs, [&] { legacyScale<T>(bytes, length, legacy_min, scale, out.data()); });
+        std::cout << name << "\n  legacy: min/max " << legacy_min_max_ms << " ms, scale "
+                  << legacy_scale_ms << " ms" << std::endl;
+
+        auto ok = true;
+        for (auto kernel : {"scalar", "sse4.1", "avx2"})
+        {
+            if (!setIntensityKernel(kernel)) continue;
+
+            auto range = nonSaturatedMinMax(type, plane.data(), length);
+            scaleTo8Bit(type, plane.data(), length, range.min, scale, out.data());
+            auto range_ok =
+                range.min == static_cast<double>(legacy_min) && range.max == static_cast<double>(legacy_max);
+            int max_diff = 0;
+            std::size_t diffs = 0;
+            for (std::size_t i = 0; i < length; i++)
+                if (auto d = std::abs(int(out[i]) - int(expected[i])); d > 0)
+                {
+                    max_diff = std::max(max_diff, d);
+                    diffs++;
+                }
+            ok &= range_ok && max_diff == 0;
+
+            auto min_max_ms = bestOf(runs, [&] { sink = sink + nonSaturatedMinMax(type, plane.data(), length).min; });
+            auto scale_ms =
+                bestOf(runs, [&] { scaleTo8Bit(type, plane.data(), length, range.min, scale, out.data()); });
+            std::cout << "  " << kernel << ": min/max " << min_max_ms << " ms (x" << legacy_min_max_ms / min_max_ms
+                      << "), scale " << scale_ms << " ms (x" << legacy_scale_ms / scale_ms << ")"
+                      << (range_ok ? "" : ", WRONG RANGE") << (diffs ? ", " + std::to_string(diffs) : std::string{})
+                      << (diffs ? " samples off by up to " + std::to_string(max_diff) : std::string{}) << std::endl;
+        }
+        return ok;
+    }
+
+    // `DisplayLut` gather against the dispatched `scaleTo8Bit` kernel, and the cost of rebuilding the table
+    template <typename T>
+    bool runLut(Reader::PixelType type, char const* name, std::size_t length)
+    {
+        constexpr int runs = 5;
+        auto plane = makePlane<T>(length);
+        auto range = nonSaturatedMinMax(type, plane.data(), length);
+        auto scale = 255. / (range.max - range.min);
+        std::vector<std::uint8_t> expected(length), out(length);
+        scaleTo8Bit(type, plane.data(), length, range.min, scale, expected.data());
+
+        DisplayLut lut;
+        auto ok = lut.setWindow(type, {range.min, range.max});
+        lut.map(plane.data(), length, out.data());
+        ok &= out == expected;
+
+        auto map_ms = bestOf(runs, [&] { lut.map(plane.data(), length, out.data()); });
+        auto window = 0;
+        auto build_ms = bestOf(runs, [&] { lut.setWindow(type, {range.min, range.max + ++window}); });
+        std::cout << name << " lut: map " << map_ms << " ms, rebuild " << build_ms << " ms"
+                  << (ok ? "" : ", WRONG RESULT") << std::endl;
+        for (auto kernel : {"scalar", "sse4.1", "avx2"})
+        {
+            if (!setIntensityKernel(kernel)) continue;
+            auto scale_ms =
+                bestOf(runs, [&] { scaleTo8Bit(type, plane.data(), length, range.min, scale, out.data()); });
+            std::cout << "  " << kernel << ": scale " << scale_ms << " ms (lut x" << scale_ms / map_ms << ")"
+                      << std::endl;
+        }
+        return ok;
+    }
+
+    // tables of the non linear mappings over every sample value of `T` with the window [`min`, `max`]
+    // (`max - min` divisible by 3 for the false color thirds)
+    template <typename T>
+    bool runLutMappings(Reader::PixelType type, char const* name, double min, double max)
+    {
+        std::vector<T> samples;
+        for (auto v = static_cast<long long>(std::numeric_limits<T>::min());
+             v <= static_cast<long long>(std::numeric_limits<T>::max()); v++)
+            samples.push_back(static_cast<T>(v));
+        auto levels = [&](LutWindow const& window) {
+            DisplayLut lut;
+            std::vector<std::uint8_t> out(samples.size());
+            if (lut.setWindow(type, window)) lut.map(samples.data(), samples.size(), out.data());
+            return out;
+        };
+        auto level = [&](std::vector<std::uint8_t> const& out, double v) {
+            return out[static_cast<std::size_t>(v - static_cast<double>(std::numeric_limits<T>::min()))];
+        };
+
+        auto linear = levels({min, max});
+        auto gamma_ok = levels({min, max, LutMapping::Gamma, 1.}) == linear;
+        auto ends_ok = true;
+        for (auto window : {LutWindow{min, max, LutMapping::Gamma, 0.5}, LutWindow{min, max, LutMapping::Gamma, 2.2},
+                            LutWindow{min, max, LutMapping::Log}})
+        {
+            auto out = levels(window);
+            ends_ok &= level(out, min) == 0 && level(out, max) == 255 && std::is_sorted(out.begin(), out.end());
+        }
+
+        DisplayLut lut;
+        auto colors_ok = lut.setWindow(type, {min, max, LutMapping::FalseColor});
+        auto third = (max - min) / 3;
+        std::array<T, 4> at{static_cast<T>(min), static_cast<T>(min + third), static_cast<T>(min + 2 * third),
+                            static_cast<T>(max)};
+        std::array<std::uint32_t, 4> colors{};
+        lut.map(at.data(), at.size(), colors.data());
+        // black, red, white, blue
+        colors_ok &= colors == std::array<std::uint32_t, 4>{0xFF000000, 0xFFFF0000, 0xFFFFFFFF, 0xFF0000FF};
+
+        std::cout << name << " lut mappings: gamma 1 " << (gamma_ok ? "matches" : "DIFFERS FROM") << " linear, "
+                  << "gamma / log ends " << (ends_ok ? "ok" : "WRONG") << ", false color "
+                  << (colors_ok ? "ok" : "WRONG") << std::endl;
+        return gamma_ok && ends_ok && colors_ok;
+    }
+
+    // min/max + scale of an UINT16 plane split in row blocks like `toIndexed8`, 1 thread up to the pool size
+    bool runParallel(std::size_t width, std::size_t height)
+    {
+        constexpr int runs = 5;
+        auto length = width * height;
+        auto plane = makePlane<std::uint16_t>(length);
+        auto type = Reader::PixelType::UINT16;
+        auto serial = nonSaturatedMinMax(type, plane.data(), length);
+        auto scale = 255. / (serial.max - serial.min);
+        std::vector<std::uint8_t> expected(length), out(length);
+        scaleTo8Bit(type, plane.data(), length, serial.min, scale, expected.data());
+
+        auto window = [&] {
+            auto range = parallelReduce(
+                static_cast<qsizetype>(height), IntensityRange{std::numeric_limits<double>::max(), 0.},
+                [&](qsizetype begin, qsizetype end) {
+                    return nonSaturatedMinMax(type, plane.data() + begin * width, (end - begin) * width);
+                },
+                [](IntensityRange a, IntensityRange b) {
+                    return IntensityRange{std::min(a.min, b.min), std::max(a.max, b.max)};
+                },
+                rowGrain(width));
+            parallelFor(
+                static_cast<qsizetype>(height),
+                [&](qsizetype begin, qsizetype end) {
+                    scaleTo8Bit(type, plane.data() + begin * width, (end - begin) * width, range.min, scale,
+                                out.data() + begin * width);
+                },
+                rowGrain(width));
+            return range;
+        };
+
+        auto ok = true;
+        auto max_threads = parallelThreadCount();
+        double single_ms = 0;
+        std::cout << "UINT16 windowing, " << intensityKernel() << " kernel" << std::endl;
+        for (auto threads = 1; threads <= max_threads; threads++)
+        {
+            setParallelThreadCount(threads);
+            auto range = window();
+            auto same = range.min == serial.min && range.max == serial.max && out == expected;
+            ok &= same;
+            auto ms = bestOf(runs, [&] { sink = sink + window().min; });
+            if (threads == 1) single_ms = ms;
+            std::cout << "  " << threads << " threads: " << ms << " ms (x" << single_ms / ms << ")"
+                      << (same ? "" : ", WRONG RESULT") << std::endl;
+        }
+        setParallelThreadCount(0);
+        return ok;
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::size_t width = argc > 1 ? std::stoul(argv[1]) : 4096;
+    std::size_t height = argc > 2 ? std::stoul(argv[2]) : 4096;
+    auto length = width * height;
+    std::cout << width << " x " << height << ", default kernel: " << intensityKernel() << std::endl;
+
+    auto ok = true;
+    ok &= run<std::int8_t>(Reader::PixelType::INT8, "INT8", length);
+    ok &= run<std::uint8_t>(Reader::PixelType::UINT8, "UINT8", length);
+    ok &= run<std::int16_t>(Reader::PixelType::INT16, "INT16", length);
+    ok &= run<std::uint16_t>(Reader::PixelType::UINT16, "UINT16", length);
+    ok &= run<std::int32_t>(Reader::PixelType::INT32, "INT32", length);
+    ok &= run<std::uint32_t>(Reader::PixelType::UINT32, "UINT32", length);
+    ok &= run<float>(Reader::PixelType::FLOAT, "FLOAT", length);
+    ok &= run<double>(Reader::PixelType::DOUBLE, "DOUBLE", length);
+    ok &= runLut<std::int16_t>(Reader::PixelType::INT16, "INT16", length);
+    ok &= runLut<std::uint16_t>(Reader::PixelType::UINT16, "UINT16", length);
+    ok &= runLutMappings<std::int16_t>(Reader::PixelType::INT16, "INT16", -1500, 1500);
+    ok &= runLutMappings<std::uint16_t>(Reader::PixelType::UINT16, "UINT16", 300, 3300);
+    ok &= runParallel(width, height);
+    std::cout << (ok ? "all kernels match" : "MISMATCH") << std::endl;
+
+    return ok ? 0 : 1;
+}
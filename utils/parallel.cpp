@@ -0,0 +1,73 @@
+#include "parallel.hpp"
+
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <latch>
+#include <memory>
+
+namespace
+{
+    std::atomic<int> thread_count = 0;
+
+    // shared with the pool tasks, which may only start after `parallelFor` returned and then find no block left
+    struct Loop
+    {
+        std::function<void(qsizetype, qsizetype)> body;
+        qsizetype count;
+        qsizetype block_size;
+        qsizetype blocks;
+        std::atomic<qsizetype> next = 0;
+        std::latch done;
+
+        Loop(std::function<void(qsizetype, qsizetype)> const& body_, qsizetype count_, qsizetype block_size_)
+            : body(body_), count(count_), block_size(block_size_), blocks((count_ + block_size_ - 1) / block_size_),
+              done(blocks)
+        {
+        }
+
+        void run()
+        {
+            for (auto block = next++; block < blocks; block = next++)
+            {
+                auto begin = block * block_size;
+                body(begin, std::min(begin + block_size, count));
+                done.count_down();
+            }
+        }
+    };
+} // namespace
+
+void parallelFor(qsizetype count, std::function<void(qsizetype begin, qsizetype end)> const& body, qsizetype grain)
+{
+    if (count <= 0) return;
+    grain = std::max<qsizetype>(grain, 1);
+    auto threads = static_cast<qsizetype>(parallelThreadCount());
+    if (threads <= 1 || count <= grain)
+    {
+        body(0, count);
+        return;
+    }
+
+    // a few blocks per thread to even out uneven blocks / threads joining late
+    auto block_size = std::max(grain, (count + threads * 4 - 1) / (threads * 4));
+    auto loop = std::make_shared<Loop>(body, count, block_size);
+    auto helpers = std::min(threads, loop->blocks) - 1;
+    auto* pool = QThreadPool::globalInstance();
+    for (qsizetype i = 0; i < helpers; i++)
+        pool->start([loop] { loop->run(); });
+    loop->run();
+    loop->done.wait();
+}
+
+void setParallelThreadCount(int threads)
+{
+    thread_count = std::max(threads, 0);
+}
+
+int parallelThreadCount()
+{
+    auto threads = thread_count.load();
+    return threads > 0 ? threads : QThreadPool::globalInstance()->maxThreadCount() + 1;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+
+// data parallel loops on the shared `QThreadPool::globalInstance()`, no threads are created per call
+
+// runs `body(begin, end)` over blocks of [0, count) of at least `grain` items, the calling thread processes
+// blocks too and returns once all of them are done, so nested calls / a saturated pool can not deadlock
+void parallelFor(qsizetype count, std::function<void(qsizetype begin, qsizetype end)> const& body,
+                 qsizetype grain = 1);
+
+// `parallelFor` where every block yields a partial result (`map(begin, end)`), combined with `reduce`
+template <typename T, typename Map, typename Reduce>
+T parallelReduce(qsizetype count, T init, Map&& map, Reduce&& reduce, qsizetype grain = 1)
+{
+    std::mutex mutex;
+    T result = std::move(init);
+    parallelFor(
+        count,
+        [&](qsizetype begin, qsizetype end) {
+            auto partial = map(begin, end);
+            std::lock_guard lock(mutex);
+            result = reduce(std::move(result), std::move(partial));
+        },
+        grain);
+    return result;
+}
+
+// rows per `parallelFor` block of an image `width` pixels wide, blocks of ~64k pixels amortize the scheduling
+inline qsizetype rowGrain(qsizetype width)
+{
+    return std::max<qsizetype>(1, (qsizetype(1) << 16) / std::max<qsizetype>(width, 1));
+}
+
+// threads taking part in a `parallelFor` (the calling one included), 0 means all of the pool's threads + 1
+void setParallelThreadCount(int threads);
+int parallelThreadCount();
@@ -1,28 +1,10 @@
 #include "plane2qimg.hpp"
+#include "display_lut.hpp"
+#include "parallel.hpp"
 
 #include <qDebug>
 
-template <typename T> std::pair<T, T> minMax(char* bytes, qsizetype length)
-{
-    T min = std::numeric_limits<T>::max(), max = std::numeric_limits<T>::min();
-    auto* ptr = reinterpret_cast<T*>(bytes);
-    for (qsizetype i = 0; i < length; i++)
-    {
-        // non-saturated black
-        if (ptr[i] > std::numeric_limits<T>::min()) min = std::min(ptr[i], min);
-        // non-saturated white
-        if (ptr[i] < std::numeric_limits<T>::max()) max = std::max(ptr[i], max);
-    }
-    return std::make_pair(min, max);
-}
-
-template <typename T> bool m_qFuzzyCompare(T a, T b)
-{
-    if constexpr (std::is_floating_point_v<T>)
-        return qFuzzyCompare(a, b);
-    else
-        return a == b;
-}
+#include <limits>
 
 template <typename T> QList<uint> prepareLut(std::vector<std::array<T, 3>>* lut)
 {
@@ -34,11 +16,12 @@ template <typename T> QList<uint> prepareLut(std::vector<std::array<T, 3>>* lut)
     return qlut;
 }
 
-template <typename T> QImage toIndexed8(char* bytes, int width, int height, QList<uint> const& lut = {})
+QImage windowToQImage(Reader::PixelType type, char const* bytes, int width, int height, IntensityRange window,
+                      QList<uint> const& lut)
 {
-    auto length = static_cast<qsizetype>(width) * height;
-    auto [min, max] = minMax<T>(bytes, length);
-    if (m_qFuzzyCompare(min, max))
+    auto min = window.min, max = window.max;
+    auto is_float = type == Reader::PixelType::FLOAT || type == Reader::PixelType::DOUBLE;
+    if (is_float ? qFuzzyCompare(min, max) || min > max : min >= max)
     {
         qCritical() << "invalid min max range";
         return QImage();
@@ -57,19 +40,55 @@ template <typename T> QImage toIndexed8(char* bytes, int width, int height, QLis
     }
     else
         img.setColorTable(lut);
-    auto* in_p = reinterpret_cast<T*>(bytes);
-    auto* out_p = reinterpret_cast<uint8_t*>(img.bits());
-    for (auto i = 0; i < length; i++)
-        out_p[i] = std::clamp(static_cast<int>(std::round((in_p[i] - min) * scale)), 0, 255);
+    // rows of `Format_Indexed8` are 32 bit aligned
+    auto bytes_per_row = static_cast<qsizetype>(width) * Reader::getBytesPerPixel(type);
+    auto* out = img.bits();
+    auto out_stride = img.bytesPerLine();
+    // 16 bit samples go through a 65536 entries table (rebuilt only when the window changes) unless the AVX2 kernel
+    // is available, which scales faster than the table gathers (see intensity_test)
+    static thread_local DisplayLut display_lut;
+    auto use_lut = (type == Reader::PixelType::UINT16 || type == Reader::PixelType::INT16) &&
+                   intensityKernel() != "avx2" && display_lut.setWindow(type, {min, max});
+    auto const& table = display_lut;
+    parallelFor(
+        height,
+        [&](qsizetype begin, qsizetype end) {
+            if (use_lut)
+                for (auto y = begin; y < end; y++)
+                    table.map(bytes + y * bytes_per_row, width, out + y * out_stride);
+            else if (out_stride == width)
+                scaleTo8Bit(type, bytes + begin * bytes_per_row, (end - begin) * width, min, scale,
+                            out + begin * width);
+            else
+                for (auto y = begin; y < end; y++)
+                    scaleTo8Bit(type, bytes + y * bytes_per_row, width, min, scale, out + y * out_stride);
+        },
+        rowGrain(width));
     return img;
 }
 
+QImage toIndexed8(Reader::PixelType type, char* bytes, int width, int height, QList<uint> const& lut = {})
+{
+    auto bytes_per_row = static_cast<qsizetype>(width) * Reader::getBytesPerPixel(type);
+    // per block of rows, the partial ranges are merged afterwards
+    auto range = parallelReduce(
+        static_cast<qsizetype>(height),
+        IntensityRange{std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()},
+        [&](qsizetype begin, qsizetype end) {
+            return nonSaturatedMinMax(type, bytes + begin * bytes_per_row, (end - begin) * width);
+        },
+        [](IntensityRange a, IntensityRange b) {
+            return IntensityRange{std::min(a.min, b.min), std::max(a.max, b.max)};
+        },
+        rowGrain(width));
+    return windowToQImage(type, bytes, width, height, range, lut);
+}
+
 QImage bytesToQImage(Reader const& reader, char* const bytes, int width, int height)
 {
     auto bytesPerPixel = reader.getBytesPerPixel();
     auto type = reader.getPixelType();
     auto rgbChannelCount = reader.getRGBChannelCount();
-    auto lut8 = reader.get8BitLut();
 
     //auto lut16 = reader.get16BitLut();
     //QList<uint> lut;
@@ -82,7 +101,7 @@ QImage bytesToQImage(Reader const& reader, char* const bytes, int width, int hei
     // only indexed8 qimage support color table...
     // so may need to convert 16bit image to RGB32 (like what i do in gray16 false color...)
     // here just ignore 16bit lut...
-    auto lut = prepareLut(lut8.get());
+    auto lut = planeLut(reader);
 
     //qDebug() << rgbChannelCount << Reader::pixelTypeStr(type) << bytesPerPixel << width << height;
 
@@ -92,27 +111,27 @@ QImage bytesToQImage(Reader const& reader, char* const bytes, int width, int hei
         {
         // 8bit lut
         case Reader::PixelType::UINT8:
-            return toIndexed8<uint8_t>(bytes, width, height, lut);
+            return toIndexed8(type, bytes, width, height, lut);
         case Reader::PixelType::INT8:
-            return toIndexed8<int8_t>(bytes, width, height, lut);
+            return toIndexed8(type, bytes, width, height, lut);
         // 16bit lut
         case Reader::PixelType::UINT16:
-            return toIndexed8<uint16_t>(bytes, width, height, lut);
+            return toIndexed8(type, bytes, width, height, lut);
         case Reader::PixelType::INT16:
-            return toIndexed8<int16_t>(bytes, width, height, lut);
+            return toIndexed8(type, bytes, width, height, lut);
         // followings do NOT have LUT
         case Reader::PixelType::BIT:
             return QImage((uchar*)bytes, width, height, static_cast<qsizetype>(width) * bytesPerPixel,
                           QImage::Format::Format_Mono)
                 .copy();
         case Reader::PixelType::INT32:
-            return toIndexed8<int32_t>(bytes, width, height);
+            return toIndexed8(type, bytes, width, height);
         case Reader::PixelType::UINT32:
-            return toIndexed8<uint32_t>(bytes, width, height);
+            return toIndexed8(type, bytes, width, height);
         case Reader::PixelType::FLOAT:
-            return toIndexed8<float>(bytes, width, height);
+            return toIndexed8(type, bytes, width, height);
         case Reader::PixelType::DOUBLE:
-            return toIndexed8<double>(bytes, width, height);
+            return toIndexed8(type, bytes, width, height);
         default:
             return QImage();
         }
@@ -159,6 +178,22 @@ QImage bytesToQImage(Reader const& reader, char* const bytes, int width, int hei
     }
 }
 
+bool isWindowable(Reader const& reader)
+{
+    return reader.getRGBChannelCount() == 1 && reader.getPixelType() != Reader::PixelType::BIT;
+}
+
+QList<uint> planeLut(Reader const& reader)
+{
+    // 16 bit luts are ignored, see `bytesToQImage`
+    auto type = reader.getPixelType();
+    if (type != Reader::PixelType::UINT8 && type != Reader::PixelType::INT8 && type != Reader::PixelType::UINT16 &&
+        type != Reader::PixelType::INT16)
+        return {};
+    auto lut8 = reader.get8BitLut();
+    return prepareLut(lut8.get());
+}
+
 QImage readPlaneToQimage(Reader const& reader, int plane_index)
 {
     auto width = reader.getSizeX();
@@ -172,7 +207,16 @@ QImage readPlaneTileToQimage(Reader const& reader, int plane_index, int x, int y
 {
     auto width = reader.getOptimalTileWidth();
     auto height = reader.getOptimalTileHeight();
-    auto tile = reader.getTile(plane_index, x, y, width, height);
+    auto tile = reader.getRegion(plane_index, x, y, width, height);
     auto bytes = tile.get();
     return bytesToQImage(reader, bytes, width, height);
 }
+
+QImage readRegionToQimage(Reader const& reader, int plane_index, int x, int y, int w, int h, IntensityRange window,
+                          QList<uint> const& lut)
+{
+    auto region = reader.getRegion(plane_index, x, y, w, h);
+    if (!region) return QImage();
+    if (isWindowable(reader)) return windowToQImage(reader.getPixelType(), region.get(), w, h, window, lut);
+    return bytesToQImage(reader, region.get(), w, h);
+}
@@ -3,6 +3,21 @@
 #include <QImage>
 
 #include "../bfwrapper/reader.hpp"
+#include "intensity.hpp"
 
 QImage readPlaneToQimage(Reader const& reader, int plane_index);
 QImage readPlaneTileToQimage(Reader const& reader, int plane_index, int x, int y);
+// `w` x `h` region at (`x`, `y`) of the current resolution (`Reader::getRegion`), single channel planes are windowed
+// with `window`
+// (e.g. the one of the whole plane, so that neighbouring regions match)
+QImage readRegionToQimage(Reader const& reader, int plane_index, int x, int y, int w, int h, IntensityRange window,
+                          QList<uint> const& lut = {});
+
+// single channel (non BIT) planes, shown through `windowToQImage`
+bool isWindowable(Reader const& reader);
+// color table of the current series for `windowToQImage`, empty for grayscale
+QList<uint> planeLut(Reader const& reader);
+// indexed 8 bit image of a single channel plane with intensities in `window` stretched over the color table,
+// only a LUT pass: changing the window does not need the plane to be read or scanned again
+QImage windowToQImage(Reader::PixelType type, char const* bytes, int width, int height, IntensityRange window,
+                      QList<uint> const& lut = {});
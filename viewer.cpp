@@ -6,13 +6,13 @@ Viewer::Viewer(QWidget* parent): QWidget(parent), ui(new Ui::Viewer)
     ui->setupUi(this);
 
     connect(ui->image5dviewer, &Image5DViewer::fileOpened,
-            [this](QString const& path, QSize sz, int depth, QString const& xml) {
+            [this](QString const& path, QSize sz, int depth) {
                 ui->fileinfoviewer->setPath(path);
                 ui->fileinfoviewer->setImageInfo(sz, depth);
-                if (!xml.isEmpty()) ui->fileinfoviewer->setExtra(xml);
+                ui->fileinfoviewer->setExtra({});
             });
     connect(ui->image5dviewer, &Image5DViewer::seriesChanged,
-            [this](int series_no) { ui->fileinfoviewer->setExtra(series_no); });
+            [this](int, Reader::MetadataFields const& metadata) { ui->fileinfoviewer->setExtra(metadata); });
 }
 
 Viewer::~Viewer()
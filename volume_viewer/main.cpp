@@ -1,4 +1,6 @@
 #include "../bfwrapper/reader.hpp"
+#include "../bfwrapper/readerpool.hpp"
+#include "../bfwrapper/stopwatch.hpp"
 
 #include <cassert>
 
@@ -55,12 +57,18 @@ int main(int argc, char* argv[])
 
     size_t dataSize = (size_t)planeSize * depth;
     auto buffer = std::make_unique<unsigned char[]>(dataSize);
-    auto ptr = buffer.get();
-    for (auto i = 0; i < depth; i++)
     {
-        auto plane = reader.getPlane(reader.getPlaneIndex(i, channel, timepoint));
-        std::memcpy(ptr, plane.get(), planeSize);
-        ptr += planeSize;
+        TIME_BLOCK("read z-stack");
+        std::vector<int> planes(depth);
+        for (auto i = 0; i < depth; i++)
+            planes[i] = reader.getPlaneIndex(i, channel, timepoint);
+        // one `Reader` per core, each decodes its planes straight into `buffer`
+        ReaderPool pool(argv[1], series, std::min(depth, (int)std::thread::hardware_concurrency()));
+        if (!pool.readPlanesInto(planes, std::as_writable_bytes(std::span(buffer.get(), dataSize))))
+        {
+            std::cerr << "Error: failed to read z-stack" << std::endl;
+            return -1;
+        }
     }
 
     vtkNew<vtkImageImport> imageImport;